@@ -0,0 +1,289 @@
+#ifndef CPPJIEBA_DICT_SNAPSHOT_H
+#define CPPJIEBA_DICT_SNAPSHOT_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "limonp/Logging.hpp"
+
+namespace cppjieba {
+
+/*
+ * Binary snapshot of a fully built dictionary (DictTrie + HMMModel).
+ *
+ * Layout: SnapshotHeader, then the DictTrie section, then the HMMModel
+ * section. Sections are sequences of scalars and length-prefixed POD arrays
+ * written with SnapshotWriter and read back with SnapshotReader. The header
+ * records the size and mtime of every source file, so a snapshot that no
+ * longer matches its text dictionaries is ignored instead of loaded.
+ *
+ * The file is mmapped read-only; arrays are copied out with memcpy straight
+ * into the trie / table vectors, so loading involves no text parsing, no
+ * UTF-8 decoding, no weight computation and no trie construction.
+ */
+static const char SNAPSHOT_MAGIC[8] = {'C', 'J', 'B', 'S', 'N', 'A', 'P', '\0'};
+static const uint32_t SNAPSHOT_VERSION = 1;
+static const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+static const size_t SNAPSHOT_SOURCE_NUM = 3; // dict, user dict, hmm model
+
+struct SnapshotSource {
+  uint64_t size;
+  int64_t mtime;
+};
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  SnapshotSource sources[SNAPSHOT_SOURCE_NUM];
+  uint64_t dict_offset;
+  uint64_t hmm_offset;
+  uint64_t total_size;
+};
+
+// Size and mtime of each '|' / ';' separated path (user dicts may be several files).
+inline bool StatSources(const std::string& paths, SnapshotSource& out) {
+  out.size = 0;
+  out.mtime = 0;
+  size_t begin = 0;
+  while (begin <= paths.size()) {
+    size_t end = paths.find_first_of("|;", begin);
+    if (end == std::string::npos) {
+      end = paths.size();
+    }
+    if (end > begin) {
+      struct stat st;
+      if (stat(paths.substr(begin, end - begin).c_str(), &st) != 0) {
+        return false;
+      }
+      out.size += static_cast<uint64_t>(st.st_size);
+      if (static_cast<int64_t>(st.st_mtime) > out.mtime) {
+        out.mtime = static_cast<int64_t>(st.st_mtime);
+      }
+    }
+    begin = end + 1;
+  }
+  return true;
+}
+
+class SnapshotWriter {
+ public:
+  template <typename T>
+  void Put(const T& value) {
+    const char* p = reinterpret_cast<const char*>(&value);
+    buf_.insert(buf_.end(), p, p + sizeof(T));
+  }
+
+  template <typename T>
+  void PutArray(const T* data, size_t n) {
+    Put<uint64_t>(n);
+    const char* p = reinterpret_cast<const char*>(data);
+    buf_.insert(buf_.end(), p, p + n * sizeof(T));
+  }
+
+  template <typename T>
+  void PutArray(const std::vector<T>& v) {
+    PutArray(v.data(), v.size());
+  }
+
+  size_t Size() const {
+    return buf_.size();
+  }
+
+  const std::vector<char>& Data() const {
+    return buf_;
+  }
+
+ private:
+  std::vector<char> buf_;
+};
+
+class SnapshotReader {
+ public:
+  SnapshotReader(const char* data, size_t size)
+    : data_(data), size_(size), pos_(0), ok_(true) {
+  }
+
+  template <typename T>
+  bool Get(T& value) {
+    if (!ok_ || size_ - pos_ < sizeof(T)) {
+      ok_ = false;
+      return false;
+    }
+    memcpy(&value, data_ + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+
+  template <typename T>
+  bool GetArray(std::vector<T>& v) {
+    uint64_t n = 0;
+    if (!Get(n) || n > (size_ - pos_) / sizeof(T)) {
+      ok_ = false;
+      return false;
+    }
+    v.resize(n);
+    if (n > 0) {
+      memcpy(v.data(), data_ + pos_, n * sizeof(T));
+    }
+    pos_ += n * sizeof(T);
+    return true;
+  }
+
+  bool Ok() const {
+    return ok_;
+  }
+
+ private:
+  const char* data_;
+  size_t size_;
+  size_t pos_;
+  bool ok_;
+};
+
+// A read-only mapping of a snapshot file whose header has been validated.
+class DictSnapshot {
+ public:
+  DictSnapshot() : data_(NULL), size_(0) {
+  }
+
+  DictSnapshot(const std::string& path, const std::string& dict_path,
+        const std::string& user_dict_paths, const std::string& model_path)
+    : data_(NULL), size_(0) {
+    if (!path.empty()) {
+      Open(path, dict_path, user_dict_paths, model_path);
+    }
+  }
+
+  ~DictSnapshot() {
+    Close();
+  }
+
+  DictSnapshot(const DictSnapshot&) = delete;
+  DictSnapshot& operator=(const DictSnapshot&) = delete;
+
+  bool Valid() const {
+    return data_ != NULL;
+  }
+
+  SnapshotReader DictSection() const {
+    return SnapshotReader(data_ + header_.dict_offset, header_.hmm_offset - header_.dict_offset);
+  }
+
+  SnapshotReader HMMSection() const {
+    return SnapshotReader(data_ + header_.hmm_offset, header_.total_size - header_.hmm_offset);
+  }
+
+  // Releases the mapping once DictTrie and HMMModel have copied what they need.
+  void Close() {
+    if (data_ != NULL) {
+      munmap(const_cast<char*>(data_), size_);
+      data_ = NULL;
+      size_ = 0;
+    }
+  }
+
+  static bool Write(const std::string& path,
+        const std::string& dict_path,
+        const std::string& user_dict_paths,
+        const std::string& model_path,
+        const SnapshotWriter& dict_section,
+        const SnapshotWriter& hmm_section) {
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    if (!StatSources(dict_path, header.sources[0]) ||
+        !StatSources(user_dict_paths, header.sources[1]) ||
+        !StatSources(model_path, header.sources[2])) {
+      XLOG(ERROR) << "stat dictionary sources failed";
+      return false;
+    }
+    header.dict_offset = sizeof(header);
+    header.hmm_offset = header.dict_offset + dict_section.Size();
+    header.total_size = header.hmm_offset + hmm_section.Size();
+
+    // Write to a temporary file and rename, so readers never map a half-written image.
+    std::string tmp = path + ".tmp";
+    std::ofstream ofs(tmp.c_str(), std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) {
+      XLOG(ERROR) << "open " << tmp << " failed";
+      return false;
+    }
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(dict_section.Data().data(), dict_section.Size());
+    ofs.write(hmm_section.Data().data(), hmm_section.Size());
+    ofs.close();
+    if (!ofs || rename(tmp.c_str(), path.c_str()) != 0) {
+      XLOG(ERROR) << "write " << path << " failed";
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  bool Open(const std::string& path, const std::string& dict_path,
+        const std::string& user_dict_paths, const std::string& model_path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader)) {
+      close(fd);
+      XLOG(WARNING) << "snapshot " << path << " is too small, ignored";
+      return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+      XLOG(WARNING) << "mmap " << path << " failed, snapshot ignored";
+      return false;
+    }
+    data_ = static_cast<const char*>(addr);
+    size_ = size;
+
+    memcpy(&header_, data_, sizeof(header_));
+    SnapshotSource sources[SNAPSHOT_SOURCE_NUM];
+    bool fresh = StatSources(dict_path, sources[0]) &&
+      StatSources(user_dict_paths, sources[1]) &&
+      StatSources(model_path, sources[2]);
+    for (size_t i = 0; fresh && i < SNAPSHOT_SOURCE_NUM; i++) {
+      fresh = sources[i].size == header_.sources[i].size &&
+        sources[i].mtime == header_.sources[i].mtime;
+    }
+
+    if (memcmp(header_.magic, SNAPSHOT_MAGIC, sizeof(header_.magic)) != 0 ||
+        header_.version != SNAPSHOT_VERSION ||
+        header_.byte_order != SNAPSHOT_BYTE_ORDER ||
+        header_.total_size != size_ ||
+        header_.dict_offset > header_.hmm_offset ||
+        header_.hmm_offset > header_.total_size) {
+      XLOG(WARNING) << "snapshot " << path << " has an incompatible format, ignored";
+      Close();
+      return false;
+    }
+    if (!fresh) {
+      XLOG(WARNING) << "snapshot " << path << " is older than its dictionaries, ignored";
+      Close();
+      return false;
+    }
+    return true;
+  }
+
+  const char* data_;
+  size_t size_;
+  SnapshotHeader header_;
+};
+
+} // namespace cppjieba
+
+#endif // CPPJIEBA_DICT_SNAPSHOT_H
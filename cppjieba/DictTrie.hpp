@@ -9,11 +9,13 @@
 #include <deque>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include "limonp/StringUtil.hpp"
 #include "limonp/Logging.hpp"
 #include "Unicode.hpp"
 #include "Trie.hpp"
+#include "DictSnapshot.hpp"
 
 namespace cppjieba {
 
@@ -22,6 +24,16 @@ const double MAX_DOUBLE = 3.14e+100;
 const size_t DICT_COLUMN_NUM = 3;
 const char* const UNKNOWN_TAG = "";
 
+// Tags PosTagger gives to words without a dictionary tag; they always get
+// the first ids of the tag table.
+static const char* const POS_M = "m";
+static const char* const POS_ENG = "eng";
+static const char* const POS_X = "x";
+const uint32_t TAG_ID_M = 0;
+const uint32_t TAG_ID_ENG = 1;
+const uint32_t TAG_ID_X = 2;
+const uint32_t NO_TAG_ID = 0xFFFFFFFFu;
+
 class DictTrie {
  public:
   enum UserWordWeightOption {
@@ -30,10 +42,29 @@ class DictTrie {
     WordWeightMax,
   }; // enum UserWordWeightOption
 
-  DictTrie(const std::string& dict_path, const std::string& user_dict_paths = "", UserWordWeightOption user_word_weight_opt = WordWeightMedian) {
+  DictTrie(const std::string& dict_path, const std::string& user_dict_paths = "", UserWordWeightOption user_word_weight_opt = WordWeightMedian)
+   : trie_(NULL), from_snapshot_(false) {
+    InitTags();
     Init(dict_path, user_dict_paths, user_word_weight_opt);
   }
 
+  // Loads from snapshot when it is valid, otherwise parses the text dictionaries.
+  DictTrie(const DictSnapshot& snapshot, const std::string& dict_path, const std::string& user_dict_paths = "", UserWordWeightOption user_word_weight_opt = WordWeightMedian)
+   : trie_(NULL), from_snapshot_(false) {
+    InitTags();
+    if (snapshot.Valid()) {
+      SnapshotReader reader = snapshot.DictSection();
+      from_snapshot_ = LoadSnapshot(reader, user_word_weight_opt);
+      if (!from_snapshot_) {
+        XLOG(WARNING) << "dictionary snapshot is damaged, loading " << dict_path << " instead";
+        Reset();
+      }
+    }
+    if (!from_snapshot_) {
+      Init(dict_path, user_dict_paths, user_word_weight_opt);
+    }
+  }
+
   ~DictTrie() {
     delete trie_;
   }
@@ -106,6 +137,69 @@ class DictTrie {
     return min_weight_;
   }
 
+  bool FromSnapshot() const {
+    return from_snapshot_;
+  }
+
+  // Id of tag in the tag table, NO_TAG_ID if no word carries it.
+  uint32_t TagId(const std::string& tag) const {
+    std::unordered_map<std::string, uint32_t>::const_iterator it = tag_ids_.find(tag);
+    return it == tag_ids_.end() ? NO_TAG_ID : it->second;
+  }
+
+  const std::string& TagName(uint32_t tag_id) const {
+    assert(tag_id < tags_.size());
+    return tags_[tag_id];
+  }
+
+  size_t TagCount() const {
+    return tags_.size();
+  }
+
+  /*
+   * Serializes the dictionary as loaded from files: DictUnits as flat
+   * weight / rune / tag pools, the weight statistics and the trie arrays.
+   * Words added later with InsertUserWord are not included.
+   */
+  void SaveSnapshot(SnapshotWriter& writer) const {
+    std::vector<double> weights(static_node_infos_.size());
+    std::vector<uint32_t> word_offsets(1, 0);
+    std::vector<Rune> runes;
+    std::vector<uint32_t> tag_ids(static_node_infos_.size());
+    std::vector<uint32_t> tag_offsets(1, 0);
+    std::vector<char> tag_chars;
+    std::unordered_map<std::string, uint32_t> tag_index;
+    for (size_t i = 0; i < static_node_infos_.size(); i++) {
+      const DictUnit& unit = static_node_infos_[i];
+      weights[i] = unit.weight;
+      runes.insert(runes.end(), unit.word.begin(), unit.word.end());
+      word_offsets.push_back(static_cast<uint32_t>(runes.size()));
+      std::unordered_map<std::string, uint32_t>::const_iterator it = tag_index.find(unit.tag);
+      if (it == tag_index.end()) {
+        it = tag_index.insert(std::make_pair(unit.tag, static_cast<uint32_t>(tag_offsets.size() - 1))).first;
+        tag_chars.insert(tag_chars.end(), unit.tag.begin(), unit.tag.end());
+        tag_offsets.push_back(static_cast<uint32_t>(tag_chars.size()));
+      }
+      tag_ids[i] = it->second;
+    }
+
+    writer.Put<uint32_t>(static_cast<uint32_t>(user_word_weight_opt_));
+    writer.Put(freq_sum_);
+    writer.Put(min_weight_);
+    writer.Put(max_weight_);
+    writer.Put(median_weight_);
+    writer.Put(user_word_default_weight_);
+    writer.PutArray(weights);
+    writer.PutArray(word_offsets);
+    writer.PutArray(runes);
+    writer.PutArray(tag_ids);
+    writer.PutArray(tag_offsets);
+    writer.PutArray(tag_chars);
+    std::vector<Rune> singles(user_dict_single_chinese_word_.begin(), user_dict_single_chinese_word_.end());
+    writer.PutArray(singles);
+    trie_->Save(writer, static_node_infos_.data(), static_node_infos_.size());
+  }
+
   void InserUserDictNode(const std::string& line) {
     std::vector<std::string> buf;
     DictUnit node_info;
@@ -164,6 +258,7 @@ class DictTrie {
 
  private:
   void Init(const std::string& dict_path, const std::string& user_dict_paths, UserWordWeightOption user_word_weight_opt) {
+    user_word_weight_opt_ = user_word_weight_opt;
     LoadDict(dict_path);
     freq_sum_ = CalcFreqSum(static_node_infos_);
     CalculateWeight(static_node_infos_, freq_sum_);
@@ -176,6 +271,90 @@ class DictTrie {
     CreateTrie(static_node_infos_);
   }
 
+  bool LoadSnapshot(SnapshotReader& reader, UserWordWeightOption user_word_weight_opt) {
+    uint32_t opt = 0;
+    if (!reader.Get(opt) || opt != static_cast<uint32_t>(user_word_weight_opt)) {
+      return false; // user words without a frequency were weighted with another option
+    }
+    user_word_weight_opt_ = user_word_weight_opt;
+    std::vector<double> weights;
+    std::vector<uint32_t> word_offsets;
+    std::vector<Rune> runes;
+    std::vector<uint32_t> tag_ids;
+    std::vector<uint32_t> tag_offsets;
+    std::vector<char> tag_chars;
+    std::vector<Rune> singles;
+    if (!reader.Get(freq_sum_) || !reader.Get(min_weight_) || !reader.Get(max_weight_) ||
+        !reader.Get(median_weight_) || !reader.Get(user_word_default_weight_) ||
+        !reader.GetArray(weights) || !reader.GetArray(word_offsets) || !reader.GetArray(runes) ||
+        !reader.GetArray(tag_ids) || !reader.GetArray(tag_offsets) || !reader.GetArray(tag_chars) ||
+        !reader.GetArray(singles)) {
+      return false;
+    }
+    size_t n = weights.size();
+    if (n == 0 || word_offsets.size() != n + 1 || tag_ids.size() != n || tag_offsets.empty()) {
+      return false;
+    }
+
+    std::vector<std::string> tags(tag_offsets.size() - 1);
+    for (size_t i = 0; i < tags.size(); i++) {
+      if (tag_offsets[i] > tag_offsets[i + 1] || tag_offsets[i + 1] > tag_chars.size()) {
+        return false;
+      }
+      tags[i].assign(tag_chars.data() + tag_offsets[i], tag_offsets[i + 1] - tag_offsets[i]);
+    }
+    std::vector<uint32_t> tag_table_ids(tags.size());
+    for (size_t i = 0; i < tags.size(); i++) {
+      tag_table_ids[i] = InternTag(tags[i]);
+    }
+
+    static_node_infos_.resize(n);
+    for (size_t i = 0; i < n; i++) {
+      if (word_offsets[i] > word_offsets[i + 1] || word_offsets[i + 1] > runes.size() || tag_ids[i] >= tags.size()) {
+        return false;
+      }
+      DictUnit& unit = static_node_infos_[i];
+      unit.word.clear();
+      for (uint32_t j = word_offsets[i]; j < word_offsets[i + 1]; j++) {
+        unit.word.push_back(runes[j]);
+      }
+      unit.weight = weights[i];
+      unit.tag = tags[tag_ids[i]];
+      unit.tag_id = tag_table_ids[tag_ids[i]];
+    }
+    user_dict_single_chinese_word_.insert(singles.begin(), singles.end());
+
+    trie_ = new Trie();
+    return trie_->Load(reader, static_node_infos_.data(), static_node_infos_.size());
+  }
+
+  void Reset() {
+    delete trie_;
+    trie_ = NULL;
+    static_node_infos_.clear();
+    user_dict_single_chinese_word_.clear();
+    InitTags();
+  }
+
+  void InitTags() {
+    tags_.clear();
+    tag_ids_.clear();
+    InternTag(POS_M);
+    InternTag(POS_ENG);
+    InternTag(POS_X);
+  }
+
+  uint32_t InternTag(const std::string& tag) {
+    std::unordered_map<std::string, uint32_t>::const_iterator it = tag_ids_.find(tag);
+    if (it != tag_ids_.end()) {
+      return it->second;
+    }
+    uint32_t tag_id = static_cast<uint32_t>(tags_.size());
+    tags_.push_back(tag);
+    tag_ids_.insert(std::make_pair(tag, tag_id));
+    return tag_id;
+  }
+
   void CreateTrie(const std::vector<DictUnit>& dictUnits) {
     assert(dictUnits.size());
     std::vector<Unicode> words;
@@ -198,6 +377,7 @@ class DictTrie {
     }
     node_info.weight = weight;
     node_info.tag = tag;
+    node_info.tag_id = InternTag(tag);
     return true;
   }
 
@@ -274,6 +454,10 @@ class DictTrie {
   double median_weight_;
   double user_word_default_weight_;
   std::unordered_set<Rune> user_dict_single_chinese_word_;
+  UserWordWeightOption user_word_weight_opt_;
+  bool from_snapshot_;
+  std::deque<std::string> tags_; // tag id -> tag, references stay valid as tags are added
+  std::unordered_map<std::string, uint32_t> tag_ids_;
 };
 }
 
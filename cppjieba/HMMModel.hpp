@@ -3,6 +3,8 @@
 
 #include "limonp/StringUtil.hpp"
 #include "Trie.hpp"
+#include "DictTrie.hpp"
+#include "DictSnapshot.hpp"
 
 namespace cppjieba {
 
@@ -16,20 +18,86 @@ struct HMMModel {
    * */
   enum {B = 0, E = 1, M = 2, S = 3, STATUS_SUM = 4};
 
-  HMMModel(const string& modelPath) {
+  // Runes covered by denseEmit: the CJK Unified Ideographs block.
+  static constexpr Rune DENSE_EMIT_BEGIN = 0x4E00;
+  static constexpr Rune DENSE_EMIT_END = 0xA000;
+
+  HMMModel(const string& modelPath) : fromSnapshot(false) {
+    InitTables();
+    LoadModel(modelPath);
+  }
+  // Loads from snapshot when it is valid, otherwise parses modelPath.
+  HMMModel(const DictSnapshot& snapshot, const string& modelPath) : fromSnapshot(false) {
+    InitTables();
+    if (snapshot.Valid()) {
+      SnapshotReader reader = snapshot.HMMSection();
+      fromSnapshot = LoadSnapshot(reader);
+      if (!fromSnapshot) {
+        XLOG(WARNING) << "hmm snapshot is damaged, loading " << modelPath << " instead";
+        InitTables();
+      }
+    }
+    if (!fromSnapshot) {
+      LoadModel(modelPath);
+    }
+  }
+  ~HMMModel() {
+  }
+  void InitTables() {
     memset(startProb, 0, sizeof(startProb));
     memset(transProb, 0, sizeof(transProb));
     statMap[0] = 'B';
     statMap[1] = 'E';
     statMap[2] = 'M';
     statMap[3] = 'S';
+    emitProbVec.clear();
     emitProbVec.push_back(&emitProbB);
     emitProbVec.push_back(&emitProbE);
     emitProbVec.push_back(&emitProbM);
     emitProbVec.push_back(&emitProbS);
-    LoadModel(modelPath);
+    for (size_t i = 0; i < emitProbVec.size(); i++) {
+      emitProbVec[i]->clear();
+    }
   }
-  ~HMMModel() {
+  // Start/transition probabilities, then each emission table as rune-sorted (rune, prob) arrays.
+  void SaveSnapshot(SnapshotWriter& writer) const {
+    writer.PutArray(&startProb[0], STATUS_SUM);
+    writer.PutArray(&transProb[0][0], STATUS_SUM * STATUS_SUM);
+    for (size_t i = 0; i < emitProbVec.size(); i++) {
+      vector<pair<Rune, double> > entries(emitProbVec[i]->begin(), emitProbVec[i]->end());
+      sort(entries.begin(), entries.end());
+      vector<Rune> runes(entries.size());
+      vector<double> probs(entries.size());
+      for (size_t j = 0; j < entries.size(); j++) {
+        runes[j] = entries[j].first;
+        probs[j] = entries[j].second;
+      }
+      writer.PutArray(runes);
+      writer.PutArray(probs);
+    }
+  }
+  bool LoadSnapshot(SnapshotReader& reader) {
+    vector<double> start, trans;
+    if (!reader.GetArray(start) || !reader.GetArray(trans) ||
+        start.size() != STATUS_SUM || trans.size() != STATUS_SUM * STATUS_SUM) {
+      return false;
+    }
+    memcpy(startProb, start.data(), sizeof(startProb));
+    memcpy(transProb, trans.data(), sizeof(transProb));
+    vector<Rune> runes;
+    vector<double> probs;
+    for (size_t i = 0; i < emitProbVec.size(); i++) {
+      if (!reader.GetArray(runes) || !reader.GetArray(probs) || runes.size() != probs.size()) {
+        return false;
+      }
+      EmitProbMap& mp = *emitProbVec[i];
+      mp.reserve(runes.size());
+      for (size_t j = 0; j < runes.size(); j++) {
+        mp[runes[j]] = probs[j];
+      }
+    }
+    BuildDenseEmit();
+    return true;
   }
   void LoadModel(const string& filePath) {
     ifstream ifile(filePath.c_str());
@@ -70,6 +138,8 @@ struct HMMModel {
     //Load emitProbS
     XCHECK(GetLine(ifile, line));
     XCHECK(LoadEmitProb(line, emitProbS));
+
+    BuildDenseEmit();
   }
   double GetEmitProb(const EmitProbMap* ptMp, Rune key, 
         double defVal)const {
@@ -79,6 +149,31 @@ struct HMMModel {
     }
     return cit->second;
   }
+  /*
+   * Emission log-probabilities of rune for all STATUS_SUM states, MIN_DOUBLE
+   * where the model has none. Runes in the dense block are one indexed load
+   * (the four states are adjacent); others are looked up in the maps and
+   * written to buf, which must hold STATUS_SUM doubles.
+   */
+  const double* GetEmitProbs(Rune rune, double* buf) const {
+    if (rune >= DENSE_EMIT_BEGIN && rune < DENSE_EMIT_END) {
+      return &denseEmit[(rune - DENSE_EMIT_BEGIN) * STATUS_SUM];
+    }
+    for (size_t y = 0; y < STATUS_SUM; y++) {
+      buf[y] = GetEmitProb(emitProbVec[y], rune, MIN_DOUBLE);
+    }
+    return buf;
+  }
+  void BuildDenseEmit() {
+    denseEmit.assign((DENSE_EMIT_END - DENSE_EMIT_BEGIN) * STATUS_SUM, MIN_DOUBLE);
+    for (size_t y = 0; y < emitProbVec.size(); y++) {
+      for (EmitProbMap::const_iterator it = emitProbVec[y]->begin(); it != emitProbVec[y]->end(); ++it) {
+        if (it->first >= DENSE_EMIT_BEGIN && it->first < DENSE_EMIT_END) {
+          denseEmit[(it->first - DENSE_EMIT_BEGIN) * STATUS_SUM + y] = it->second;
+        }
+      }
+    }
+  }
   bool GetLine(ifstream& ifile, string& line) {
     while (getline(ifile, line)) {
       Trim(line);
@@ -122,6 +217,8 @@ struct HMMModel {
   EmitProbMap emitProbM;
   EmitProbMap emitProbS;
   vector<EmitProbMap* > emitProbVec;
+  vector<double> denseEmit; // [(rune - DENSE_EMIT_BEGIN) * STATUS_SUM + state], built from the maps
+  bool fromSnapshot;
 }; // struct HMMModel
 
 } // namespace cppjieba
@@ -112,7 +112,7 @@ class HMMSegment: public SegmentBase {
     return begin;
   }
   void InternalCut(RuneStrArray::const_iterator begin, RuneStrArray::const_iterator end, vector<WordRange>& res) const {
-    vector<size_t> status;
+    vector<size_t>& status = GetScratch().status;
     Viterbi(begin, end, status);
 
     RuneStrArray::const_iterator left = begin;
@@ -127,46 +127,70 @@ class HMMSegment: public SegmentBase {
     }
   }
 
+  // Viterbi tables reused across calls; one per thread since segmenters are shared.
+  struct ViterbiScratch {
+    vector<double> weight;
+    vector<int> path;
+    vector<size_t> status;
+  };
+
+  static ViterbiScratch& GetScratch() {
+    static thread_local ViterbiScratch scratch;
+    return scratch;
+  }
+
   void Viterbi(RuneStrArray::const_iterator begin, 
         RuneStrArray::const_iterator end, 
         vector<size_t>& status) const {
-    size_t Y = HMMModel::STATUS_SUM;
+    const size_t Y = HMMModel::STATUS_SUM;
     size_t X = end - begin;
+    size_t stat;
+    double endE, endS;
 
-    size_t XYSize = X * Y;
-    size_t now, old, stat;
-    double tmp, endE, endS;
-
-    vector<int> path(XYSize);
-    vector<double> weight(XYSize);
+    // Laid out [x * Y + y], so the four states of one rune are adjacent.
+    ViterbiScratch& scratch = GetScratch();
+    if (scratch.weight.size() < X * Y) {
+      scratch.weight.resize(X * Y);
+      scratch.path.resize(X * Y);
+    }
+    double* weight = scratch.weight.data();
+    int* path = scratch.path.data();
+    double emitBuf[Y];
 
     //start
+    const double* emitProb = model_->GetEmitProbs(begin->rune, emitBuf);
     for (size_t y = 0; y < Y; y++) {
-      weight[0 + y * X] = model_->startProb[y] + model_->GetEmitProb(model_->emitProbVec[y], begin->rune, MIN_DOUBLE);
-      path[0 + y * X] = -1;
+      weight[y] = model_->startProb[y] + emitProb[y];
+      path[y] = -1;
     }
 
-    double emitProb;
-
     for (size_t x = 1; x < X; x++) {
+      emitProb = model_->GetEmitProbs((begin+x)->rune, emitBuf);
+      const double* prev = weight + (x - 1) * Y;
+      double best[Y];
+      int from[Y];
       for (size_t y = 0; y < Y; y++) {
-        now = x + y*X;
-        weight[now] = MIN_DOUBLE;
-        path[now] = HMMModel::E; // warning
-        emitProb = model_->GetEmitProb(model_->emitProbVec[y], (begin+x)->rune, MIN_DOUBLE);
-        for (size_t preY = 0; preY < Y; preY++) {
-          old = x - 1 + preY * X;
-          tmp = weight[old] + model_->transProb[preY][y] + emitProb;
-          if (tmp > weight[now]) {
-            weight[now] = tmp;
-            path[now] = preY;
-          }
+        best[y] = MIN_DOUBLE;
+        from[y] = HMMModel::E; // warning
+      }
+      // The y loop has no dependencies between lanes, so it is written
+      // branch-free for the compiler to vectorize.
+      for (size_t preY = 0; preY < Y; preY++) {
+        for (size_t y = 0; y < Y; y++) {
+          double tmp = prev[preY] + model_->transProb[preY][y] + emitProb[y];
+          bool better = tmp > best[y];
+          best[y] = better ? tmp : best[y];
+          from[y] = better ? static_cast<int>(preY) : from[y];
         }
       }
+      for (size_t y = 0; y < Y; y++) {
+        weight[x * Y + y] = best[y];
+        path[x * Y + y] = from[y];
+      }
     }
 
-    endE = weight[X-1+HMMModel::E*X];
-    endS = weight[X-1+HMMModel::S*X];
+    endE = weight[(X-1) * Y + HMMModel::E];
+    endS = weight[(X-1) * Y + HMMModel::S];
     stat = 0;
     if (endE >= endS) {
       stat = HMMModel::E;
@@ -177,7 +201,7 @@ class HMMSegment: public SegmentBase {
     status.resize(X);
     for (int x = X -1 ; x >= 0; x--) {
       status[x] = stat;
-      stat = path[x + stat*X];
+      stat = path[x * Y + stat];
     }
   }
 
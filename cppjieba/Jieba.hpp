@@ -12,9 +12,14 @@ class Jieba {
         const string& model_path = "",
         const string& user_dict_path = "", 
         const string& idf_path = "", 
-        const string& stop_word_path = "") 
-    : dict_trie_(getPath(dict_path, "jieba.dict.utf8"), getPath(user_dict_path, "user.dict.utf8")),
-      model_(getPath(model_path, "hmm_model.utf8")),
+        const string& stop_word_path = "",
+        const string& snapshot_path = "") 
+    : dict_path_(getPath(dict_path, "jieba.dict.utf8")),
+      model_path_(getPath(model_path, "hmm_model.utf8")),
+      user_dict_path_(getPath(user_dict_path, "user.dict.utf8")),
+      snapshot_(snapshot_path, dict_path_, user_dict_path_, model_path_),
+      dict_trie_(snapshot_, dict_path_, user_dict_path_),
+      model_(snapshot_, model_path_),
       mp_seg_(&dict_trie_),
       hmm_seg_(&model_),
       mix_seg_(&dict_trie_, &model_),
@@ -23,6 +28,7 @@ class Jieba {
       extractor(&dict_trie_, &model_, 
                 getPath(idf_path, "idf.utf8"), 
                 getPath(stop_word_path, "stop_words.utf8")) {
+    snapshot_.Close(); // everything has been copied out of the mapping
   }
   ~Jieba() {
   }
@@ -67,9 +73,19 @@ class Jieba {
   void Tag(const string& sentence, vector<pair<string, string> >& words) const {
     mix_seg_.Tag(sentence, words);
   }
+  // Writes (offset, length, tag id) records into spans; see MixSegment::Tag.
+  void Tag(const char* s, size_t len, vector<TagSpan>& spans, SegmentScratch* scratch = NULL) const {
+    mix_seg_.Tag(s, len, spans, scratch);
+  }
   string LookupTag(const string &str) const {
     return mix_seg_.LookupTag(str);
   }
+  const string& TagName(uint32_t tag_id) const {
+    return dict_trie_.TagName(tag_id);
+  }
+  size_t TagCount() const {
+    return dict_trie_.TagCount();
+  }
   bool InsertUserWord(const string& word, const string& tag = UNKNOWN_TAG) {
     return dict_trie_.InsertUserWord(word, tag);
   }
@@ -104,6 +120,21 @@ class Jieba {
     return &model_;
   }
 
+  // True when the dictionary and HMM model were both loaded from the snapshot.
+  bool LoadedFromSnapshot() const {
+    return dict_trie_.FromSnapshot() && model_.fromSnapshot;
+  }
+
+  // Writes a snapshot of the dictionary and HMM model for later constructions.
+  bool SaveSnapshot(const string& snapshot_path) const {
+    SnapshotWriter dict_section;
+    SnapshotWriter hmm_section;
+    dict_trie_.SaveSnapshot(dict_section);
+    model_.SaveSnapshot(hmm_section);
+    return DictSnapshot::Write(snapshot_path, dict_path_, user_dict_path_, model_path_,
+          dict_section, hmm_section);
+  }
+
   void LoadUserDict(const vector<string>& buf)  {
     dict_trie_.LoadUserDict(buf);
   }
@@ -150,6 +181,10 @@ class Jieba {
     return path;
   }
 
+  string dict_path_;
+  string model_path_;
+  string user_dict_path_;
+  DictSnapshot snapshot_; // mapped only during construction
   DictTrie dict_trie_;
   HMMModel model_;
   
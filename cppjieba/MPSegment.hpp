@@ -52,17 +52,22 @@ class MPSegment: public SegmentTagged {
     words.reserve(wrs.size());
     GetWordsFromWordRanges(sentence, wrs, words);
   }
+  // When units is given, the DictUnit of every word (NULL for a single
+  // character not in the dictionary) is appended to it, parallel to words.
+  // The DAG is built in scratch (the thread's own one if NULL).
   void Cut(RuneStrArray::const_iterator begin,
            RuneStrArray::const_iterator end,
            vector<WordRange>& words,
-           size_t max_word_len = MAX_WORD_LENGTH) const {
-    vector<Dag> dags;
+           size_t max_word_len = MAX_WORD_LENGTH,
+           vector<const DictUnit*>* units = NULL,
+           SegmentScratch* scratch = NULL) const {
+    vector<Dag>& dags = (scratch ? *scratch : SegmentScratch::ThreadLocal()).dags;
     dictTrie_->Find(begin, 
           end, 
           dags,
           max_word_len);
     CalcDP(dags);
-    CutByDag(begin, end, dags, words);
+    CutByDag(begin, end, dags, words, units);
   }
 
   const DictTrie* GetDictTrie() const {
@@ -109,10 +114,14 @@ class MPSegment: public SegmentTagged {
   void CutByDag(RuneStrArray::const_iterator begin, 
         RuneStrArray::const_iterator end, 
         const vector<Dag>& dags, 
-        vector<WordRange>& words) const {
+        vector<WordRange>& words,
+        vector<const DictUnit*>* units) const {
     size_t i = 0;
     while (i < dags.size()) {
       const DictUnit* p = dags[i].pInfo;
+      if (units) {
+        units->push_back(p);
+      }
       if (p) {
         assert(p->word.size() >= 1);
         WordRange wr(begin + i, begin + i + p->word.size() - 1);
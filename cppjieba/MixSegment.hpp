@@ -43,22 +43,34 @@ class MixSegment: public SegmentTagged {
     GetWordsFromWordRanges(sentence, wrs, words);
   }
 
-  void Cut(RuneStrArray::const_iterator begin, RuneStrArray::const_iterator end, vector<WordRange>& res, bool hmm) const {
+  // When units is given, the DictUnit of every word in res is appended to it
+  // (NULL if the word is not in the dictionary): taken from the DAG for words
+  // kept from MPSegment, looked up on the runes for words produced by HMM.
+  // Intermediate results go to scratch (the thread's own one if NULL); res
+  // and units must not be containers of that same scratch other than wrs/units.
+  void Cut(RuneStrArray::const_iterator begin, RuneStrArray::const_iterator end, vector<WordRange>& res, bool hmm,
+        vector<const DictUnit*>* units = NULL, SegmentScratch* scratch = NULL) const {
+    SegmentScratch& sc = scratch ? *scratch : SegmentScratch::ThreadLocal();
     if (!hmm) {
-      mpSeg_.Cut(begin, end, res);
+      mpSeg_.Cut(begin, end, res, MAX_WORD_LENGTH, units, &sc);
       return;
     }
-    vector<WordRange> words;
+    vector<WordRange>& words = sc.mpWords;
+    vector<const DictUnit*>& mpUnits = sc.mpUnits;
+    vector<WordRange>& hmmRes = sc.hmmRes;
+    words.clear();
+    mpUnits.clear();
+    hmmRes.clear();
     assert(end >= begin);
-    words.reserve(end - begin);
-    mpSeg_.Cut(begin, end, words);
+    mpSeg_.Cut(begin, end, words, MAX_WORD_LENGTH, units ? &mpUnits : NULL, &sc);
 
-    vector<WordRange> hmmRes;
-    hmmRes.reserve(end - begin);
     for (size_t i = 0; i < words.size(); i++) {
       //if mp Get a word, it's ok, put it into result
       if (words[i].left != words[i].right || (words[i].left == words[i].right && mpSeg_.IsUserDictSingleChineseWord(words[i].left->rune))) {
         res.push_back(words[i]);
+        if (units) {
+          units->push_back(mpUnits[i]);
+        }
         continue;
       }
 
@@ -75,6 +87,9 @@ class MixSegment: public SegmentTagged {
       //put hmm result to result
       for (size_t k = 0; k < hmmRes.size(); k++) {
         res.push_back(hmmRes[k]);
+        if (units) {
+          units->push_back(GetDictTrie()->Find(hmmRes[k].left, hmmRes[k].right + 1));
+        }
       }
 
       //clear tmp vars
@@ -89,8 +104,59 @@ class MixSegment: public SegmentTagged {
     return mpSeg_.GetDictTrie();
   }
 
+  // Single pass: the tag comes from the DictUnit found while cutting, so no
+  // word is re-decoded or looked up in the trie a second time.
   bool Tag(const string& src, vector<pair<string, string> >& res) const {
-    return tagger_.Tag(src, res, *this);
+    PreFilter pre_filter(symbols_, src);
+    PreFilter::Range range;
+    vector<WordRange> wrs;
+    vector<const DictUnit*> units;
+    wrs.reserve(src.size() / 2);
+    units.reserve(src.size() / 2);
+    while (pre_filter.HasNext()) {
+      range = pre_filter.Next();
+      Cut(range.begin, range.end, wrs, true, &units);
+    }
+    assert(wrs.size() == units.size());
+    res.reserve(res.size() + wrs.size());
+    for (size_t i = 0; i < wrs.size(); i++) {
+      res.push_back(make_pair(GetStringFromRunes(src, wrs[i].left, wrs[i].right),
+            tagger_.LookupTag(units[i], wrs[i].left, wrs[i].right + 1)));
+    }
+    return !res.empty();
+  }
+
+  /*
+   * Zero-copy variant of Tag: spans is cleared and receives one TagSpan per
+   * word of [s, s + len). Runes, DAG and word ranges live in scratch (the
+   * thread's own one if NULL) and callers keep spans around between
+   * sentences, so in steady state tagging performs no heap allocation.
+   */
+  void Tag(const char* s, size_t len, vector<TagSpan>& spans, SegmentScratch* scratch = NULL) const {
+    spans.clear();
+    SegmentScratch& sc = scratch ? *scratch : SegmentScratch::ThreadLocal();
+    RuneStrArray& runes = sc.runes;
+    if (!DecodeUTF8RunesInString(s, len, runes)) {
+      XLOG(ERROR) << "UTF-8 decode failed for input sentence";
+      return;
+    }
+    vector<WordRange>& wrs = sc.wrs;
+    vector<const DictUnit*>& units = sc.units;
+    wrs.clear();
+    units.clear();
+    PreFilter pre_filter(symbols_, runes);
+    PreFilter::Range range;
+    while (pre_filter.HasNext()) {
+      range = pre_filter.Next();
+      Cut(range.begin, range.end, wrs, true, &units, &sc);
+    }
+    assert(wrs.size() == units.size());
+    spans.reserve(wrs.size());
+    for (size_t i = 0; i < wrs.size(); i++) {
+      spans.push_back(TagSpan(wrs[i].left->offset,
+            wrs[i].right->offset + wrs[i].right->len - wrs[i].left->offset,
+            tagger_.LookupTagId(units[i], wrs[i].left, wrs[i].right + 1)));
+    }
   }
 
   string LookupTag(const string &str) const {
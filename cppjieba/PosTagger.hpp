@@ -8,10 +8,6 @@
 namespace cppjieba {
 using namespace limonp;
 
-static const char* const POS_M = "m";
-static const char* const POS_ENG = "eng";
-static const char* const POS_X = "x";
-
 class PosTagger {
  public:
   PosTagger() {
@@ -39,35 +35,59 @@ class PosTagger {
         return POS_X;
       }
       tmp = dict->Find(runes.begin(), runes.end());
-      if (tmp == NULL || tmp->tag.empty()) {
-        return SpecialRule(runes);
-      } else {
-        return tmp->tag;
-      }
+      return LookupTag(tmp, runes.begin(), runes.end());
+  }
+
+  // Tag of the word [begin, end) whose DictUnit is already known (NULL if none).
+  string LookupTag(const DictUnit* unit, RuneStrArray::const_iterator begin, RuneStrArray::const_iterator end) const {
+    if (unit == NULL || unit->tag.empty()) {
+      return SpecialRule(begin, end);
+    }
+    return unit->tag;
+  }
+
+  // Same as LookupTag, as an id in the DictTrie's tag table.
+  uint32_t LookupTagId(const DictUnit* unit, RuneStrArray::const_iterator begin, RuneStrArray::const_iterator end) const {
+    if (unit == NULL || unit->tag.empty()) {
+      return SpecialRuleId(begin, end);
+    }
+    return unit->tag_id;
   }
 
  private:
-  const char* SpecialRule(const RuneStrArray& unicode) const {
+  const char* SpecialRule(RuneStrArray::const_iterator begin, RuneStrArray::const_iterator end) const {
+    switch (SpecialRuleId(begin, end)) {
+     case TAG_ID_M:
+       return POS_M;
+     case TAG_ID_ENG:
+       return POS_ENG;
+     default:
+       return POS_X;
+    }
+  }
+
+  uint32_t SpecialRuleId(RuneStrArray::const_iterator begin, RuneStrArray::const_iterator end) const {
     size_t m = 0;
     size_t eng = 0;
-    for (size_t i = 0; i < unicode.size() && eng < unicode.size() / 2; i++) {
-      if (unicode[i].rune < 0x80) {
+    size_t size = end - begin;
+    for (size_t i = 0; i < size && eng < size / 2; i++) {
+      if (begin[i].rune < 0x80) {
         eng ++;
-        if ('0' <= unicode[i].rune && unicode[i].rune <= '9') {
+        if ('0' <= begin[i].rune && begin[i].rune <= '9') {
           m++;
         }
       }
     }
     // ascii char is not found
     if (eng == 0) {
-      return POS_X;
+      return TAG_ID_X;
     }
     // all the ascii is number char
     if (m == eng) {
-      return POS_M;
+      return TAG_ID_M;
     }
     // the ascii chars contain english letter
-    return POS_ENG;
+    return TAG_ID_ENG;
   }
 
 }; // class PosTagger
@@ -6,6 +6,50 @@
 
 namespace cppjieba {
 
+/*
+ * Separator runes. PreFilter tests every rune of every sentence, so runes
+ * in the BMP (all of the default separators and nearly all text) are
+ * answered from an 8KB bitmap with one load; only runes above U+FFFF fall
+ * back to a hash set.
+ */
+class SymbolSet {
+ public:
+  SymbolSet() : bmp_(BMP_WORDS, 0) {
+  }
+
+  // Returns false if r is already in the set.
+  bool Insert(Rune r) {
+    if (r < BMP_SIZE) {
+      uint64_t bit = uint64_t(1) << (r & 63);
+      if (bmp_[r >> 6] & bit) {
+        return false;
+      }
+      bmp_[r >> 6] |= bit;
+      return true;
+    }
+    return others_.insert(r).second;
+  }
+
+  bool Contains(Rune r) const {
+    if (r < BMP_SIZE) {
+      return (bmp_[r >> 6] >> (r & 63)) & 1;
+    }
+    return !others_.empty() && others_.find(r) != others_.end();
+  }
+
+  void Clear() {
+    bmp_.assign(BMP_WORDS, 0);
+    others_.clear();
+  }
+
+ private:
+  static const Rune BMP_SIZE = 0x10000;
+  static const size_t BMP_WORDS = BMP_SIZE / 64;
+
+  vector<uint64_t> bmp_;
+  unordered_set<Rune> others_;
+}; // class SymbolSet
+
 class PreFilter {
  public:
   //TODO use WordRange instead of Range
@@ -14,24 +58,30 @@ class PreFilter {
     RuneStrArray::const_iterator end;
   }; // struct Range
 
-  PreFilter(const unordered_set<Rune>& symbols, 
+  PreFilter(const SymbolSet& symbols,
         const string& sentence)
-    : symbols_(symbols) {
+    : runes_(&sentence_), symbols_(symbols) {
     if (!DecodeUTF8RunesInString(sentence, sentence_)) {
       XLOG(ERROR) << "UTF-8 decode failed for input sentence"; 
     }
-    cursor_ = sentence_.begin();
+    cursor_ = runes_->begin();
+  }
+  // Walks runes decoded by the caller, which must outlive the filter.
+  PreFilter(const SymbolSet& symbols,
+        const RuneStrArray& runes)
+    : runes_(&runes), symbols_(symbols) {
+    cursor_ = runes_->begin();
   }
   ~PreFilter() {
   }
   bool HasNext() const {
-    return cursor_ != sentence_.end();
+    return cursor_ != runes_->end();
   }
   Range Next() {
     Range range;
     range.begin = cursor_;
-    while (cursor_ != sentence_.end()) {
-      if (IsIn(symbols_, cursor_->rune)) {
+    while (cursor_ != runes_->end()) {
+      if (symbols_.Contains(cursor_->rune)) {
         if (range.begin == cursor_) {
           cursor_ ++;
         }
@@ -40,13 +90,14 @@ class PreFilter {
       }
       cursor_ ++;
     }
-    range.end = sentence_.end();
+    range.end = runes_->end();
     return range;
   }
  private:
   RuneStrArray::const_iterator cursor_;
   RuneStrArray sentence_;
-  const unordered_set<Rune>& symbols_;
+  const RuneStrArray* runes_;
+  const SymbolSet& symbols_;
 }; // class PreFilter
 
 } // namespace cppjieba
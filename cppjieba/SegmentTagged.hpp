@@ -5,6 +5,40 @@
 
 namespace cppjieba {
 
+// One tagged word as a byte range of the input sentence; no strings are built.
+struct TagSpan {
+  uint32_t offset; // byte offset in the sentence
+  uint32_t length; // byte length
+  uint32_t tag_id; // DictTrie::TagName(tag_id) is the POS tag
+  TagSpan(uint32_t o, uint32_t l, uint32_t t)
+   : offset(o), length(l), tag_id(t) {
+  }
+}; // struct TagSpan
+
+/*
+ * Containers reused by segmentation across calls. Everything a sentence
+ * needs (decoded runes, the DAG, intermediate word ranges) lives here and
+ * keeps its capacity, so once the buffers have grown to the longest line
+ * seen, segmenting a line performs no heap allocation.
+ *
+ * A scratch may only be used by one thread at a time. Callers that do not
+ * pass one get the calling thread's own instance.
+ */
+struct SegmentScratch {
+  RuneStrArray runes;              // decoded sentence
+  vector<WordRange> wrs;           // words of the whole sentence
+  vector<const DictUnit*> units;   // DictUnit of each word in wrs
+  vector<Dag> dags;                // MPSegment DAG of one range
+  vector<WordRange> mpWords;       // MPSegment result of one range
+  vector<const DictUnit*> mpUnits; // DictUnit of each word in mpWords
+  vector<WordRange> hmmRes;        // HMMSegment result of one run of single characters
+
+  static SegmentScratch& ThreadLocal() {
+    static thread_local SegmentScratch scratch;
+    return scratch;
+  }
+}; // struct SegmentScratch
+
 class SegmentTagged : public SegmentBase{
  public:
   SegmentTagged() {
@@ -3,8 +3,12 @@
 
 #include <vector>
 #include <queue>
+#include <algorithm>
+#include <cassert>
+#include <stdint.h>
 #include "limonp/StdExtension.hpp"
 #include "Unicode.hpp"
+#include "DictSnapshot.hpp"
 
 namespace cppjieba {
 
@@ -16,6 +20,7 @@ struct DictUnit {
   Unicode word;
   double weight;
   string tag;
+  uint32_t tag_id; // id of tag in the owning DictTrie's tag table
 }; // struct DictUnit
 
 // for debugging
@@ -38,24 +43,35 @@ struct Dag {
 
 typedef Rune TrieKey;
 
-class TrieNode {
- public :
-  TrieNode(): next(NULL), ptValue(NULL) {
-  }
- public:
-  typedef unordered_map<TrieKey, TrieNode*> NextMap;
-  NextMap *next;
-  const DictUnit *ptValue;
-};
-
+/*
+ * Compact trie with sorted, contiguous child arrays.
+ *
+ * Every node is a fixed 16-byte record in one vector. The children of a
+ * node occupy the range [child_begin, child_begin + child_count) of two
+ * parallel arrays (child_keys_ / child_nodes_), sorted by rune, so a lookup
+ * is a short linear scan or a binary search over a few cache lines instead
+ * of a hash probe plus a pointer chase. The root, which has one child per
+ * distinct first character, additionally keeps a direct table for the BMP.
+ *
+ * The bulk of the dictionary is laid out once at construction. InsertNode
+ * after that appends the affected child block (with the new key) to the end
+ * of the child arrays; the old block is simply left unused.
+ *
+ * Because the layout is already flat, a DictSnapshot stores the three
+ * arrays as they are (values as indexes into the DictUnit array) and Load
+ * copies them back without rebuilding anything.
+ */
 class Trie {
  public:
   Trie(const vector<Unicode>& keys, const vector<const DictUnit*>& valuePointers)
-   : root_(new TrieNode) {
+   : nodes_(1), root_table_(ROOT_TABLE_SIZE, NONE) {
     CreateTrie(keys, valuePointers);
   }
+  // Empty trie, to be filled by Load.
+  Trie()
+   : nodes_(1), root_table_(ROOT_TABLE_SIZE, NONE) {
+  }
   ~Trie() {
-    DeleteNode(root_);
   }
 
   const DictUnit* Find(RuneStrArray::const_iterator begin, RuneStrArray::const_iterator end) const {
@@ -63,55 +79,39 @@ class Trie {
       return NULL;
     }
 
-    const TrieNode* ptNode = root_;
-    TrieNode::NextMap::const_iterator citer;
+    uint32_t node = ROOT;
     for (RuneStrArray::const_iterator it = begin; it != end; it++) {
-      if (NULL == ptNode->next) {
+      node = FindChild(node, it->rune);
+      if (NONE == node) {
         return NULL;
       }
-      citer = ptNode->next->find(it->rune);
-      if (ptNode->next->end() == citer) {
-        return NULL;
-      }
-      ptNode = citer->second;
     }
-    return ptNode->ptValue;
+    return nodes_[node].value;
   }
 
   void Find(RuneStrArray::const_iterator begin, 
         RuneStrArray::const_iterator end, 
         vector<struct Dag>&res, 
         size_t max_word_len = MAX_WORD_LENGTH) const {
-    assert(root_ != NULL);
     res.resize(end - begin);
 
-    const TrieNode *ptNode = NULL;
-    TrieNode::NextMap::const_iterator citer;
     for (size_t i = 0; i < size_t(end - begin); i++) {
       res[i].runestr = *(begin + i);
+      res[i].nexts.resize(0); // res may be reused across calls
 
-      if (root_->next != NULL && root_->next->end() != (citer = root_->next->find(res[i].runestr.rune))) {
-        ptNode = citer->second;
-      } else {
-        ptNode = NULL;
-      }
-      if (ptNode != NULL) {
-        res[i].nexts.push_back(pair<size_t, const DictUnit*>(i, ptNode->ptValue));
-      } else {
-        res[i].nexts.push_back(pair<size_t, const DictUnit*>(i, static_cast<const DictUnit*>(NULL)));
-      }
+      uint32_t node = FindChild(ROOT, res[i].runestr.rune);
+      res[i].nexts.push_back(pair<size_t, const DictUnit*>(i, NONE == node ? static_cast<const DictUnit*>(NULL) : nodes_[node].value));
 
       for (size_t j = i + 1; j < size_t(end - begin) && (j - i + 1) <= max_word_len; j++) {
-        if (ptNode == NULL || ptNode->next == NULL) {
+        if (NONE == node || 0 == nodes_[node].child_count) {
           break;
         }
-        citer = ptNode->next->find((begin + j)->rune);
-        if (ptNode->next->end() == citer) {
+        node = FindChild(node, (begin + j)->rune);
+        if (NONE == node) {
           break;
         }
-        ptNode = citer->second;
-        if (NULL != ptNode->ptValue) {
-          res[i].nexts.push_back(pair<size_t, const DictUnit*>(j, ptNode->ptValue));
+        if (NULL != nodes_[node].value) {
+          res[i].nexts.push_back(pair<size_t, const DictUnit*>(j, nodes_[node].value));
         }
       }
     }
@@ -122,78 +122,245 @@ class Trie {
       return;
     }
 
-    TrieNode::NextMap::const_iterator kmIter;
-    TrieNode *ptNode = root_;
+    uint32_t node = ROOT;
     for (Unicode::const_iterator citer = key.begin(); citer != key.end(); ++citer) {
-      if (NULL == ptNode->next) {
-        ptNode->next = new TrieNode::NextMap;
-      }
-      kmIter = ptNode->next->find(*citer);
-      if (ptNode->next->end() == kmIter) {
-        TrieNode *nextNode = new TrieNode;
-
-        ptNode->next->insert(make_pair(*citer, nextNode));
-        ptNode = nextNode;
-      } else {
-        ptNode = kmIter->second;
+      uint32_t next = FindChild(node, *citer);
+      if (NONE == next) {
+        next = AddChild(node, *citer);
       }
+      node = next;
     }
-    assert(ptNode != NULL);
-    ptNode->ptValue = ptValue;
+    nodes_[node].value = ptValue;
   }
+
+  // Removes the word itself; longer words sharing the prefix stay reachable.
   void DeleteNode(const Unicode& key, const DictUnit* ptValue) {
-      if (key.begin() == key.end()) {
+    if (key.begin() == key.end()) {
+      return;
+    }
+
+    uint32_t node = ROOT;
+    for (Unicode::const_iterator citer = key.begin(); citer != key.end(); ++citer) {
+      node = FindChild(node, *citer);
+      if (NONE == node) {
         return;
       }
-      //定义一个NextMap迭代器
-      TrieNode::NextMap::const_iterator kmIter;
-      //定义一个指向root的TrieNode指针
-      TrieNode *ptNode = root_;
-      for (Unicode::const_iterator citer = key.begin(); citer != key.end(); ++citer) {
-        //链表不存在元素
-        if (NULL == ptNode->next) {
-          return;
-        }
-        kmIter = ptNode->next->find(*citer);
-        //如果map中不存在,跳出循环
-        if (ptNode->next->end() == kmIter) {
-              break;
-        }
-        //从unordered_map中擦除该项
-        ptNode->next->erase(*citer);
-        //删除该node
-        ptNode = kmIter->second;
-        delete ptNode;
-        break;
+    }
+    nodes_[node].value = NULL;
+  }
+
+  size_t NodeCount() const {
+    return nodes_.size();
+  }
+
+  size_t MemoryUsage() const {
+    return nodes_.capacity() * sizeof(Node) +
+      child_keys_.capacity() * sizeof(TrieKey) +
+      child_nodes_.capacity() * sizeof(uint32_t) +
+      root_table_.capacity() * sizeof(uint32_t);
+  }
+
+  // Values are written as indexes into units[0, unit_count); any other value
+  // (a word inserted at runtime) is not part of the snapshot.
+  void Save(SnapshotWriter& writer, const DictUnit* units, size_t unit_count) const {
+    vector<SnapshotNode> nodes(nodes_.size());
+    for (size_t i = 0; i < nodes_.size(); i++) {
+      nodes[i].child_begin = nodes_[i].child_begin;
+      nodes[i].child_count = nodes_[i].child_count;
+      nodes[i].value = NONE;
+      const DictUnit* value = nodes_[i].value;
+      if (value != NULL && value >= units && value < units + unit_count) {
+        nodes[i].value = static_cast<uint32_t>(value - units);
       }
-      return;
- }
+    }
+    writer.PutArray(nodes);
+    writer.PutArray(child_keys_);
+    writer.PutArray(child_nodes_);
+  }
+
+  // Inverse of Save; checks every index so a damaged image is rejected, not followed.
+  bool Load(SnapshotReader& reader, const DictUnit* units, size_t unit_count) {
+    vector<SnapshotNode> nodes;
+    if (!reader.GetArray(nodes) || !reader.GetArray(child_keys_) || !reader.GetArray(child_nodes_) ||
+        nodes.empty() || child_keys_.size() != child_nodes_.size()) {
+      return false;
+    }
+    nodes_.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+      const SnapshotNode& n = nodes[i];
+      if (n.child_begin > child_keys_.size() || n.child_count > child_keys_.size() - n.child_begin ||
+          (n.value != NONE && n.value >= unit_count)) {
+        return false;
+      }
+      nodes_[i].child_begin = n.child_begin;
+      nodes_[i].child_count = n.child_count;
+      nodes_[i].value = n.value == NONE ? NULL : units + n.value;
+    }
+    for (size_t i = 0; i < child_nodes_.size(); i++) {
+      if (child_nodes_[i] == ROOT || child_nodes_[i] >= nodes_.size()) {
+        return false;
+      }
+    }
+    FillRootTable();
+    return true;
+  }
+
  private:
+  struct SnapshotNode {
+    uint32_t child_begin;
+    uint32_t child_count;
+    uint32_t value;
+  };
+
+  struct Node {
+    uint32_t child_begin;
+    uint32_t child_count;
+    const DictUnit* value;
+    Node(): child_begin(0), child_count(0), value(NULL) {
+    }
+  };
+
+  static constexpr uint32_t ROOT = 0;
+  static constexpr uint32_t NONE = 0xFFFFFFFFu;
+  static constexpr size_t ROOT_TABLE_SIZE = 0x10000;
+  static constexpr uint32_t LINEAR_SCAN_LIMIT = 8;
+
+  uint32_t FindChild(uint32_t node, TrieKey key) const {
+    if (ROOT == node && key < ROOT_TABLE_SIZE) {
+      return root_table_[key];
+    }
+    const Node& n = nodes_[node];
+    const TrieKey* keys = child_keys_.data() + n.child_begin;
+    if (n.child_count <= LINEAR_SCAN_LIMIT) {
+      for (uint32_t i = 0; i < n.child_count; i++) {
+        if (keys[i] == key) {
+          return child_nodes_[n.child_begin + i];
+        }
+      }
+      return NONE;
+    }
+    const TrieKey* pos = std::lower_bound(keys, keys + n.child_count, key);
+    if (pos == keys + n.child_count || *pos != key) {
+      return NONE;
+    }
+    return child_nodes_[n.child_begin + (pos - keys)];
+  }
+
+  // Moves the child block of node to the end of the child arrays with key inserted.
+  uint32_t AddChild(uint32_t node, TrieKey key) {
+    uint32_t child = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back(Node());
+
+    Node& n = nodes_[node];
+    uint32_t begin = n.child_begin;
+    uint32_t count = n.child_count;
+    uint32_t new_begin = static_cast<uint32_t>(child_keys_.size());
+    uint32_t pos = static_cast<uint32_t>(std::lower_bound(child_keys_.begin() + begin,
+          child_keys_.begin() + begin + count, key) - (child_keys_.begin() + begin));
+
+    child_keys_.resize(new_begin + count + 1);
+    child_nodes_.resize(new_begin + count + 1);
+    for (uint32_t i = 0, j = 0; i <= count; i++) {
+      if (i == pos) {
+        child_keys_[new_begin + i] = key;
+        child_nodes_[new_begin + i] = child;
+      } else {
+        child_keys_[new_begin + i] = child_keys_[begin + j];
+        child_nodes_[new_begin + i] = child_nodes_[begin + j];
+        j++;
+      }
+    }
+    n.child_begin = new_begin;
+    n.child_count = count + 1;
+
+    if (ROOT == node && key < ROOT_TABLE_SIZE) {
+      root_table_[key] = child;
+    }
+    return child;
+  }
+
   void CreateTrie(const vector<Unicode>& keys, const vector<const DictUnit*>& valuePointers) {
     if (valuePointers.empty() || keys.empty()) {
       return;
     }
     assert(keys.size() == valuePointers.size());
 
+    // Sort once so that every node's children are known before they are laid out.
+    // stable_sort keeps later duplicates last, so they win as with repeated InsertNode.
+    vector<size_t> order;
+    order.reserve(keys.size());
     for (size_t i = 0; i < keys.size(); i++) {
-      InsertNode(keys[i], valuePointers[i]);
+      if (keys[i].begin() != keys[i].end()) {
+        order.push_back(i);
+      }
     }
+    std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) {
+      return std::lexicographical_compare(keys[a].begin(), keys[a].end(), keys[b].begin(), keys[b].end());
+    });
+
+    nodes_.reserve(keys.size() * 2);
+    child_keys_.reserve(keys.size() * 2);
+    child_nodes_.reserve(keys.size() * 2);
+    Build(ROOT, keys, valuePointers, order, 0, order.size(), 0);
+    FillRootTable();
   }
 
-  void DeleteNode(TrieNode* node) {
-    if (NULL == node) {
+  void FillRootTable() {
+    const Node& root = nodes_[ROOT];
+    for (uint32_t i = 0; i < root.child_count; i++) {
+      if (child_keys_[root.child_begin + i] < ROOT_TABLE_SIZE) {
+        root_table_[child_keys_[root.child_begin + i]] = child_nodes_[root.child_begin + i];
+      }
+    }
+  }
+
+  // order[lo, hi) are sorted keys sharing their first depth runes, which spell node.
+  void Build(uint32_t node,
+        const vector<Unicode>& keys,
+        const vector<const DictUnit*>& valuePointers,
+        const vector<size_t>& order,
+        size_t lo, size_t hi, size_t depth) {
+    while (lo < hi && keys[order[lo]].size() == depth) {
+      nodes_[node].value = valuePointers[order[lo]];
+      lo++;
+    }
+    if (lo == hi) {
       return;
     }
-    if (NULL != node->next) {
-      for (TrieNode::NextMap::iterator it = node->next->begin(); it != node->next->end(); ++it) {
-        DeleteNode(it->second);
+
+    uint32_t count = 0;
+    for (size_t i = lo; i < hi; i++) {
+      if (i == lo || keys[order[i]][depth] != keys[order[i - 1]][depth]) {
+        count++;
+      }
+    }
+
+    uint32_t begin = static_cast<uint32_t>(child_keys_.size());
+    nodes_[node].child_begin = begin;
+    nodes_[node].child_count = count;
+    child_keys_.resize(begin + count);
+    child_nodes_.resize(begin + count);
+
+    size_t group = lo;
+    for (uint32_t c = 0; c < count; c++) {
+      TrieKey key = keys[order[group]][depth];
+      size_t end = group;
+      while (end < hi && keys[order[end]][depth] == key) {
+        end++;
       }
-      delete node->next;
+      uint32_t child = static_cast<uint32_t>(nodes_.size());
+      nodes_.push_back(Node());
+      child_keys_[begin + c] = key;
+      child_nodes_[begin + c] = child;
+      Build(child, keys, valuePointers, order, group, end, depth + 1);
+      group = end;
     }
-    delete node;
   }
 
-  TrieNode* root_;
+  vector<Node> nodes_;
+  vector<TrieKey> child_keys_;
+  vector<uint32_t> child_nodes_;
+  vector<uint32_t> root_table_;
 }; // class Trie
 } // namespace cppjieba
 
@@ -8,6 +8,11 @@
 #include <ostream>
 #include "limonp/LocalVector.hpp"
 
+#if !defined(CPPJIEBA_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPPJIEBA_UTF8_SIMD 1
+#include <immintrin.h>
+#endif
+
 namespace cppjieba {
 
 using std::string;
@@ -32,19 +37,21 @@ inline std::ostream& operator << (std::ostream& os, const Word& w) {
   return os << "{\"word\": \"" << w.word << "\", \"offset\": " << w.offset << "}";
 }
 
+// 16 bytes: len (1..4) and unicode_length (always 1 for a decoded rune)
+// fit in 16 bits, so four records share one cache line.
 struct RuneStr {
   Rune rune;
   uint32_t offset;
-  uint32_t len;
   uint32_t unicode_offset;
-  uint32_t unicode_length;
-  RuneStr(): rune(0), offset(0), len(0), unicode_offset(0), unicode_length(0) {
+  uint16_t len;
+  uint16_t unicode_length;
+  RuneStr(): rune(0), offset(0), unicode_offset(0), len(0), unicode_length(0) {
   }
   RuneStr(Rune r, uint32_t o, uint32_t l)
-    : rune(r), offset(o), len(l), unicode_offset(0), unicode_length(0) {
+    : rune(r), offset(o), unicode_offset(0), len(l), unicode_length(0) {
   }
   RuneStr(Rune r, uint32_t o, uint32_t l, uint32_t unicode_offset, uint32_t unicode_length)
-          : rune(r), offset(o), len(l), unicode_offset(unicode_offset), unicode_length(unicode_length) {
+          : rune(r), offset(o), unicode_offset(unicode_offset), len(l), unicode_length(unicode_length) {
   }
 }; // struct RuneStr
 
@@ -139,20 +146,192 @@ inline RuneStrLite DecodeUTF8ToRune(const char* str, size_t len) {
   return rp;
 }
 
+/*
+ * Bulk decoding of what makes up almost all comment text: ASCII and
+ * well-formed 3-byte sequences (CJK ideographs, full-width punctuation).
+ * A kernel classifies 16 bytes at a time with SIMD compares; a block of
+ * pure ASCII or of four 3-byte sequences is decoded entirely in registers,
+ * a mix of the two is decoded from the class masks. It stops at the first
+ * byte of any other kind (2/4-byte or malformed sequences) or when fewer
+ * than 16 bytes remain; DecodeUTF8RunesInString decodes those with
+ * DecodeUTF8ToRune. Bytes are only taken when DecodeUTF8ToRune would
+ * decode them the same way, so the result never depends on the kernel.
+ *
+ * The kernel is chosen once at runtime: AVX2 (32 ASCII bytes / 8 runes per
+ * step), SSSE3 (16 / 4), or none (NULL) on other CPUs and compilers.
+ */
+// Decodes from byte i into out[n...]; returns the new rune count.
+typedef size_t (*Utf8BulkDecoder)(const char* s, size_t len, size_t i, size_t n, RuneStr* out);
+
+#ifdef CPPJIEBA_UTF8_SIMD
+inline void StoreAsciiRunes(const char* s, size_t count, size_t& i, size_t& n, RuneStr* out) {
+  for (size_t k = 0; k < count; k++) {
+    out[n + k] = RuneStr((uint8_t)s[i + k], i + k, 1, n + k, 1);
+  }
+  i += count;
+  n += count;
+}
+
+inline void Store3ByteRunes(const uint32_t* runes, size_t count, size_t& i, size_t& n, RuneStr* out) {
+  for (size_t k = 0; k < count; k++) {
+    out[n + k] = RuneStr(runes[k], i + 3 * k, 3, n + k, 1);
+  }
+  i += 3 * count;
+  n += count;
+}
+
+// Lanes hold 4 x (b2, b1, b0, 0) of the 3-byte sequences at 0, 3, 6, 9.
+__attribute__((target("ssse3")))
+inline __m128i Decode3ByteLanes128(__m128i v) {
+  const __m128i shuf = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+  __m128i x = _mm_shuffle_epi8(v, shuf);
+  return _mm_or_si128(_mm_or_si128(
+        _mm_and_si128(x, _mm_set1_epi32(0x3F)),
+        _mm_and_si128(_mm_srli_epi32(x, 2), _mm_set1_epi32(0xFC0))),
+        _mm_and_si128(_mm_srli_epi32(x, 4), _mm_set1_epi32(0xF000)));
+}
+
+// Bit k set for each byte k that is 1110xxxx (lead) / 10xxxxxx (continuation).
+__attribute__((target("ssse3")))
+inline void ClassifyBytes128(__m128i v, int& lead, int& cont) {
+  lead = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(v, _mm_set1_epi8((char)0xF0)), _mm_set1_epi8((char)0xE0)));
+  cont = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(v, _mm_set1_epi8((char)0xC0)), _mm_set1_epi8((char)0x80)));
+}
+
+const int UTF8_LEAD_X4 = 0x249; // leads at bytes 0, 3, 6, 9
+const int UTF8_CONT_X4 = 0xDB6; // continuations at the other 8 of the first 12 bytes
+
+__attribute__((target("ssse3")))
+inline bool DecodeBlockSSSE3(const char* s, size_t len, size_t& i, size_t& n, RuneStr* out) {
+  if (i + 16 > len) {
+    return false;
+  }
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+  if (_mm_movemask_epi8(v) == 0) {
+    StoreAsciiRunes(s, 16, i, n, out);
+    return true;
+  }
+  int lead, cont;
+  ClassifyBytes128(v, lead, cont);
+  if ((lead & 0xFFF) == UTF8_LEAD_X4 && (cont & 0xFFF) == UTF8_CONT_X4) {
+    uint32_t runes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(runes), Decode3ByteLanes128(v));
+    Store3ByteRunes(runes, 4, i, n, out);
+    return true;
+  }
+  // Mixed ASCII and 3-byte text: walk the byte classes, stop at anything else.
+  int ascii = ~_mm_movemask_epi8(v);
+  size_t p = 0;
+  while (p < 16) {
+    const uint8_t* b = reinterpret_cast<const uint8_t*>(s + i + p);
+    if ((ascii >> p) & 1) {
+      out[n] = RuneStr(b[0], i + p, 1, n, 1);
+      p += 1;
+    } else if (((lead >> p) & 1) && p + 3 <= 16 && ((cont >> (p + 1)) & 3) == 3) {
+      Rune r = ((b[0] & 0x0F) << 12) | ((b[1] & 0x3F) << 6) | (b[2] & 0x3F);
+      out[n] = RuneStr(r, i + p, 3, n, 1);
+      p += 3;
+    } else {
+      break;
+    }
+    ++n;
+  }
+  i += p;
+  return p > 0;
+}
+
+__attribute__((target("ssse3")))
+inline size_t DecodeUTF8BulkSSSE3(const char* s, size_t len, size_t i, size_t n, RuneStr* out) {
+  while (DecodeBlockSSSE3(s, len, i, n, out)) {
+  }
+  return n;
+}
+
+__attribute__((target("avx2")))
+inline size_t DecodeUTF8BulkAVX2(const char* s, size_t len, size_t i, size_t n, RuneStr* out) {
+  const __m256i shuf = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+        2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+  while (i + 32 <= len) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    if (_mm256_movemask_epi8(v) == 0) {
+      StoreAsciiRunes(s, 32, i, n, out);
+      continue;
+    }
+    // Lane 0 holds bytes [0, 16), lane 1 bytes [12, 28): 8 sequences, 4 per lane.
+    __m256i w = _mm256_inserti128_si256(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 12)), 1);
+    int lead = _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+          _mm256_and_si256(w, _mm256_set1_epi8((char)0xF0)), _mm256_set1_epi8((char)0xE0)));
+    int cont = _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+          _mm256_and_si256(w, _mm256_set1_epi8((char)0xC0)), _mm256_set1_epi8((char)0x80)));
+    if ((lead & 0x0FFF0FFF) != (UTF8_LEAD_X4 | UTF8_LEAD_X4 << 16) ||
+        (cont & 0x0FFF0FFF) != (UTF8_CONT_X4 | UTF8_CONT_X4 << 16)) {
+      break;
+    }
+    __m256i x = _mm256_shuffle_epi8(w, shuf);
+    __m256i r = _mm256_or_si256(_mm256_or_si256(
+          _mm256_and_si256(x, _mm256_set1_epi32(0x3F)),
+          _mm256_and_si256(_mm256_srli_epi32(x, 2), _mm256_set1_epi32(0xFC0))),
+          _mm256_and_si256(_mm256_srli_epi32(x, 4), _mm256_set1_epi32(0xF000)));
+    uint32_t runes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(runes), r);
+    Store3ByteRunes(runes, 8, i, n, out);
+  }
+  // Mixed blocks and the tail: 16-byte steps.
+  while (DecodeBlockSSSE3(s, len, i, n, out)) {
+  }
+  return n;
+}
+#endif // CPPJIEBA_UTF8_SIMD
+
+inline Utf8BulkDecoder SelectUTF8BulkDecoder() {
+#ifdef CPPJIEBA_UTF8_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return DecodeUTF8BulkAVX2;
+  }
+  if (__builtin_cpu_supports("ssse3")) {
+    return DecodeUTF8BulkSSSE3;
+  }
+#endif
+  return NULL;
+}
+
+inline Utf8BulkDecoder GetUTF8BulkDecoder() {
+  static const Utf8BulkDecoder decoder = SelectUTF8BulkDecoder();
+  return decoder;
+}
+
+// runes keeps its buffer, so a caller reusing one array decodes without allocating.
 inline bool DecodeUTF8RunesInString(const char* s, size_t len, RuneStrArray& runes) {
-  runes.clear();
-  runes.reserve(len / 2);
-  for (uint32_t i = 0, j = 0; i < len;) {
+  runes.resize(len); // never more runes than bytes; trimmed below
+  if (len == 0) {
+    return true;
+  }
+  RuneStr* out = &runes[0];
+  const Utf8BulkDecoder bulk = GetUTF8BulkDecoder();
+  size_t i = 0;
+  size_t n = 0;
+  while (i < len) {
+    if (bulk != NULL && len - i >= 16) {
+      size_t m = bulk(s, len, i, n, out);
+      if (m > n) {
+        i = out[m - 1].offset + out[m - 1].len;
+        n = m;
+        if (i >= len) {
+          break;
+        }
+      }
+    }
     RuneStrLite rp = DecodeUTF8ToRune(s + i, len - i);
     if (rp.len == 0) {
-      runes.clear();
+      runes.resize(0);
       return false;
     }
-    RuneStr x(rp.rune, i, rp.len, j, 1);
-    runes.push_back(x);
+    out[n] = RuneStr(rp.rune, i, rp.len, n, 1);
     i += rp.len;
-    ++j;
+    ++n;
   }
+  runes.resize(n);
   return true;
 }
 
@@ -119,6 +119,12 @@ class LocalVector {
     }
     init_();
   }
+  // Unlike clear(), keeps the heap buffer, so resize(0) lets a vector be
+  // refilled without allocating again.
+  void resize(size_t size) {
+    reserve(size);
+    size_ = size;
+  }
 };
 
 template <class T>
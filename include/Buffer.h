@@ -3,48 +3,89 @@
 #define BUFFER_H
 
 #include "Common.h"
+#include "LockFreeRing.h"
 #include <vector>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <memory>
+#include <thread>
 
+/**
+ * 缓冲区实现方式，构造时选定
+ * - Locked：一把互斥锁 + 两个条件变量
+ * - SPSC：单生产者/单消费者无锁环形队列
+ * - MPMC：有界多生产者/多消费者无锁环形队列（多个统计线程时使用）
+ */
+enum class BufferMode {
+    Locked,
+    SPSC,
+    MPMC
+};
 
+/**
+ * 三种模式的语义一致：
+ * - 写满（达到 capacity）后生产者阻塞，直到数据量降到 low_watermark 以下才恢复写入
+ * - 缓冲区空时消费者阻塞，直到有数据、输入结束（markInputFinished）或关闭（close）
+ * 无锁模式只在需要阻塞时才使用互斥锁和条件变量，且仅当有线程在等待时才加锁唤醒
+ * pushBatch / popBatch 每次加锁搬运多个元素，只在空/满水位切换（有线程等待）时唤醒对方
+ */
 template<typename T>
 class Buffer {
 private:
     std::vector<T> buffer_;//缓存区
     size_t capacity_;//最大容量
     size_t low_watermark_;//剩余数据量阈值
-    
+
     size_t read_pos_;//读位置（consumer）
     size_t write_pos_;//写位置（生产者）
     size_t count_;//buffer中当前数据量
 
     bool allow_write_;
-    
+
     mutable std::mutex mutex_;
     std::condition_variable refill_cv_;
     std::condition_variable not_empty_;
-    
+
     std::atomic<bool> closed_;
     std::atomic<bool> input_finished_;
-    
+
+    // 无锁模式
+    BufferMode mode_;
+    std::unique_ptr<SpscRing<T>> spsc_;
+    std::unique_ptr<MpmcRing<T>> mpmc_;
+    std::atomic<bool> write_open_{true};//无锁模式下的 allow_write_
+    std::atomic<int> waiting_producers_{0};//阻塞中的生产者数
+    std::atomic<int> waiting_consumers_{0};//阻塞中的消费者数（Locked 模式下在锁内维护）
+
+    static constexpr int kSpinRounds = 64;//阻塞前自旋让出 CPU 的次数
+
 public:
-    Buffer(size_t capacity, size_t low_watermark)
-        : buffer_(capacity), capacity_(capacity), 
+    Buffer(size_t capacity, size_t low_watermark, BufferMode mode = BufferMode::Locked)
+        : buffer_(mode == BufferMode::Locked ? capacity : 0), capacity_(capacity),
           low_watermark_(low_watermark),
           read_pos_(0), write_pos_(0), count_(0),allow_write_(true),
-          closed_(false), input_finished_(false) {}
-    
+          closed_(false), input_finished_(false), mode_(mode) {
+        if (mode_ == BufferMode::SPSC) {
+            spsc_ = std::make_unique<SpscRing<T>>(capacity_);
+        } else if (mode_ == BufferMode::MPMC) {
+            mpmc_ = std::make_unique<MpmcRing<T>>(capacity_);
+        }
+    }
+
     bool push(T item) {
+        if (mode_ != BufferMode::Locked) {
+            return pushLockFree(item);
+        }
+
         std::unique_lock<std::mutex> lock(mutex_);
-        
+
         refill_cv_.wait(lock, [this] {
             return allow_write_ || closed_.load();
         });
-        
+
         if (closed_.load()) return false;
-        
+
         buffer_[write_pos_] = std::move(item);
         write_pos_ = (write_pos_ + 1) % capacity_;
         count_++;
@@ -52,60 +93,336 @@ public:
         if(count_==capacity_){
             allow_write_=false;
         }
-        
-        not_empty_.notify_one();
-        
+
+        if (waiting_consumers_.load() > 0) {//只有消费者在等待（缓冲区曾为空）时才唤醒
+            not_empty_.notify_one();
+        }
+
         return true;
     }
-    
+
+    /**
+     * 批量写入 [first, last) 中的元素（逐个 move），每次加锁写入尽可能多的元素
+     * 写满时与 push 一样阻塞，直到降到低水位以下
+     * @return 实际写入的个数（缓冲区关闭时可能少于输入个数）
+     */
+    template<typename It>
+    size_t pushBatch(It first, It last) {
+        if (mode_ != BufferMode::Locked) {
+            return pushBatchLockFree(first, last);
+        }
+
+        size_t pushed = 0;
+        while (first != last) {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            refill_cv_.wait(lock, [this] {
+                return allow_write_ || closed_.load();
+            });
+
+            if (closed_.load()) break;
+
+            size_t added = 0;
+            while (first != last && count_ < capacity_) {
+                buffer_[write_pos_] = std::move(*first);
+                write_pos_ = (write_pos_ + 1) % capacity_;
+                count_++;
+                ++first;
+                ++added;
+            }
+
+            if(count_==capacity_){
+                allow_write_=false;
+            }
+
+            if (waiting_consumers_.load() > 0) {
+                if (added > 1) {
+                    not_empty_.notify_all();
+                } else {
+                    not_empty_.notify_one();
+                }
+            }
+            pushed += added;
+        }
+        return pushed;
+    }
+
+    size_t pushBatch(std::vector<T>& items) {
+        return pushBatch(items.begin(), items.end());
+    }
+
     bool pop(T& item) {
+        if (mode_ != BufferMode::Locked) {
+            return popLockFree(item);
+        }
+
         std::unique_lock<std::mutex> lock(mutex_);
-        
-        not_empty_.wait(lock, [this] {
-            return count_ > 0 || closed_.load() || input_finished_.load();
-        });
-        
+
+        waitNotEmpty(lock);
+
         if (count_ == 0 && (input_finished_.load()|| closed_.load())) {
             return false;
         }
-        
+
         item = std::move(buffer_[read_pos_]);
         read_pos_ = (read_pos_ + 1) % capacity_;
         count_--;
-        
+
         if(!allow_write_ && count_<=low_watermark_){
             allow_write_=true;
             refill_cv_.notify_all();//生产者
         }
-        
+
         return true;
     }
-    
+
+    /**
+     * 批量读取：阻塞到至少有一个元素，然后一次取出至多 max_items 个追加到 out
+     * @return 取出的个数；缓冲区已空且输入结束/关闭时返回 0
+     */
+    size_t popBatch(std::vector<T>& out, size_t max_items) {
+        if (max_items == 0) {
+            return 0;
+        }
+        if (mode_ != BufferMode::Locked) {
+            return popBatchLockFree(out, max_items);
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        waitNotEmpty(lock);
+
+        size_t n = count_ < max_items ? count_ : max_items;
+        for (size_t i = 0; i < n; ++i) {
+            out.push_back(std::move(buffer_[read_pos_]));
+            read_pos_ = (read_pos_ + 1) % capacity_;
+        }
+        count_ -= n;
+
+        if(n > 0 && !allow_write_ && count_<=low_watermark_){
+            allow_write_=true;
+            refill_cv_.notify_all();//生产者
+        }
+
+        return n;
+    }
+
     void markInputFinished() {
         input_finished_.store(true);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);//与阻塞中的消费者同步，避免丢失唤醒
+        }
         not_empty_.notify_all();
     }
-    
+
     void close() {
         closed_.store(true);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
         refill_cv_.notify_all();
         not_empty_.notify_all();
     }
-    
+
     size_t size() const {
+        if (mode_ != BufferMode::Locked) {
+            return ringSize();
+        }
         std::lock_guard<std::mutex> lock(mutex_);
         return count_;
     }
-    
+
     size_t available() const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return capacity_ - count_;
+        size_t used = size();
+        return used < capacity_ ? capacity_ - used : 0;
     }
-    
+
     bool empty() const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return count_ == 0;
+        return size() == 0;
+    }
+
+    BufferMode mode() const { return mode_; }
+
+private:
+    //Locked 模式：等待到有数据、输入结束或关闭，等待期间登记为等待中的消费者
+    void waitNotEmpty(std::unique_lock<std::mutex>& lock) {
+        auto ready = [this] {
+            return count_ > 0 || closed_.load() || input_finished_.load();
+        };
+        if (ready()) {
+            return;
+        }
+        waiting_consumers_.fetch_add(1);
+        not_empty_.wait(lock, ready);
+        waiting_consumers_.fetch_sub(1);
+    }
+
+    bool ringPush(T& item) {
+        return mode_ == BufferMode::SPSC ? spsc_->tryPush(item) : mpmc_->tryPush(item);
+    }
+
+    bool ringPop(T& item) {
+        return mode_ == BufferMode::SPSC ? spsc_->tryPop(item) : mpmc_->tryPop(item);
+    }
+
+    size_t ringSize() const {
+        return mode_ == BufferMode::SPSC ? spsc_->size() : mpmc_->size();
+    }
+
+    /**
+     * 先自旋若干轮，仍未就绪则登记为等待者并在条件变量上阻塞
+     * 等待者计数先于条件检查递增，唤醒方先修改状态再读计数，二者不会同时错过对方
+     */
+    template<typename Ready>
+    void park(std::condition_variable& cv, std::atomic<int>& waiters, Ready ready) {
+        for (int i = 0; i < kSpinRounds; ++i) {
+            if (ready()) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters.fetch_add(1);
+        cv.wait(lock, ready);
+        waiters.fetch_sub(1);
+    }
+
+    //有线程在等待时才加锁唤醒
+    void wake(std::condition_variable& cv, std::atomic<int>& waiters, bool all) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load() > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (all) {
+                cv.notify_all();
+            } else {
+                cv.notify_one();
+            }
+        }
+    }
+
+    //达到高水位：停止写入；若消费者已把数据取到低水位以下则立即恢复
+    void stopWrite() {
+        write_open_.store(false);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ringSize() <= low_watermark_) {
+            resumeWrite();
+        }
+    }
+
+    void resumeWrite() {
+        bool expected = false;
+        if (write_open_.compare_exchange_strong(expected, true)) {
+            wake(refill_cv_, waiting_producers_, true);
+        }
+    }
+
+    //取出数据后检查是否降到低水位
+    void afterPop() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!write_open_.load() && ringSize() <= low_watermark_) {
+            resumeWrite();
+        }
+    }
+
+    bool pushLockFree(T& item) {
+        while (true) {
+            if (closed_.load()) {
+                return false;
+            }
+            if (write_open_.load()) {
+                if (ringPush(item)) {
+                    if (ringSize() >= capacity_) {
+                        stopWrite();
+                    }
+                    wake(not_empty_, waiting_consumers_, false);
+                    return true;
+                }
+                stopWrite();//环已满（多生产者时可能先于计数到达上限）
+            }
+            park(refill_cv_, waiting_producers_, [this] {
+                return write_open_.load() || closed_.load();
+            });
+        }
+    }
+
+    template<typename It>
+    size_t pushBatchLockFree(It first, It last) {
+        size_t pushed = 0;
+        while (first != last) {
+            if (closed_.load()) {
+                break;
+            }
+            size_t added = 0;
+            if (write_open_.load()) {
+                while (first != last && ringPush(*first)) {
+                    ++first;
+                    ++added;
+                }
+                if (first != last || ringSize() >= capacity_) {
+                    stopWrite();
+                }
+            }
+            if (added > 0) {
+                wake(not_empty_, waiting_consumers_, added > 1);
+                pushed += added;
+            }
+            if (first != last) {
+                park(refill_cv_, waiting_producers_, [this] {
+                    return write_open_.load() || closed_.load();
+                });
+            }
+        }
+        return pushed;
+    }
+
+    size_t popBatchLockFree(std::vector<T>& out, size_t max_items) {
+        while (true) {
+            size_t n = 0;
+            T item;
+            while (n < max_items && ringPop(item)) {
+                out.push_back(std::move(item));
+                ++n;
+            }
+            if (n > 0) {
+                afterPop();
+                return n;
+            }
+            if (input_finished_.load() || closed_.load()) {
+                //结束标记之前写入的数据仍需取完
+                while (n < max_items && ringPop(item)) {
+                    out.push_back(std::move(item));
+                    ++n;
+                }
+                if (n > 0) {
+                    afterPop();
+                }
+                return n;
+            }
+            park(not_empty_, waiting_consumers_, [this] {
+                return ringSize() > 0 || input_finished_.load() || closed_.load();
+            });
+        }
+    }
+
+    bool popLockFree(T& item) {
+        while (true) {
+            if (ringPop(item)) {
+                afterPop();
+                return true;
+            }
+            if (input_finished_.load() || closed_.load()) {
+                //结束标记之前写入的数据仍需取完
+                if (ringPop(item)) {
+                    afterPop();
+                    return true;
+                }
+                return false;
+            }
+            park(not_empty_, waiting_consumers_, [this] {
+                return ringSize() > 0 || input_finished_.load() || closed_.load();
+            });
+        }
     }
 };
 
-#endif // BUFFER_H
\ No newline at end of file
+#endif // BUFFER_H
@@ -6,12 +6,15 @@
 #include <vector>
 #include <cstdint>
 
+// 词 ID（由 WordDict 分配的稠密编号）
+using WordId = uint32_t;
+
 /**
  * 带时间戳的时间槽
  */
 struct TimeSlot {
     unsigned int timestamp;             // 时间戳（秒）
-    std::vector<std::string> words={}; // 该时刻的所有词
+    std::vector<WordId> words={};      // 该时刻的所有词（WordDict 中的 ID）
     
     TimeSlot(unsigned int ts = 0) : timestamp(ts) {}
 };
@@ -22,9 +25,10 @@ struct TimeSlot {
 struct QueryCommand {
     unsigned int timestamp;  // 查询时刻的时间戳
     int k;               // Top-K 的 K 值
+    size_t after_slots;  // 输入中位于该查询之前、已写入 Buffer 的时间槽数
     
-    QueryCommand(unsigned int ts = 0, int k_val = 10) 
-        : timestamp(ts), k(k_val) {}
+    QueryCommand(unsigned int ts = 0, int k_val = 10, size_t after = 0) 
+        : timestamp(ts), k(k_val), after_slots(after) {}
 };
 
 #endif // COMMON_H
\ No newline at end of file
@@ -0,0 +1,119 @@
+// 近似词频统计：Count-Min Sketch + 高频候选堆
+#ifndef COUNTMINCOUNTER_H
+#define COUNTMINCOUNTER_H
+
+#include "WordCounter.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 用 depth 行 x width 列的计数矩阵代替逐词计数表，另维护一个容量固定的候选小顶堆：
+ * - add：每行按各自的哈希累加一个计数器，O(depth)；支持负增量
+ * - count：各行计数器的最小值，不小于真实词频；以至少 1 - delta 的概率误差不超过 epsilon * total
+ * - 候选堆：词频更新后若估计值超过堆中最小值则换入，topK 只在候选中排序
+ *
+ * 按窗口构造时（window_seconds、panes 非 0）还负责窗口淘汰：窗口按时间划分为若干段，
+ * 每段另存一个同样大小的计数矩阵，addAt 同时累加到总矩阵和所属段；某段整段早于淘汰线时
+ * 把它从总矩阵中减去并清空（Count-Min 是线性的，减去后与从未加入一致）。
+ * 滑动窗口因此不再按秒保存逐词增量，内存只取决于 epsilon、delta、候选数和段数，与词表大小无关；
+ * 代价是淘汰粒度为一段，窗口最多多保留一段的时长（词频只会偏高，不会偏低）。
+ *
+ * 非线程安全，由外层（SlidingWindow）加锁。
+ */
+class CountMinCounter final : public WordCounter {
+public:
+    /**
+     * @param epsilon 相对误差上限，列数取 e / epsilon 向上取到 2 的幂
+     * @param delta 超出误差上限的概率，行数取 ln(1 / delta) 向上取整
+     * @param heavy_hitters 候选高频词数（topK 最多返回这么多个词）
+     * @param window_seconds 滑动窗口大小（秒），与 panes 同时非 0 时按时间段淘汰
+     * @param panes 窗口划分的时间段数，每段时长为 (window_seconds + 1) / panes 向上取整
+     */
+    CountMinCounter(double epsilon, double delta, size_t heavy_hitters,
+                    unsigned int window_seconds = 0, size_t panes = 0);
+
+    void add(WordId id, int delta) override;
+
+    bool windowed() const override { return !panes_.empty(); }
+
+    //累加到总矩阵和 ts 所属的时间段
+    void addAt(unsigned int ts, WordId id, int delta) override;
+
+    //从总矩阵中减去整段早于 expire_time 的时间段，并按新的估计值整理候选堆
+    void expireBefore(unsigned int expire_time) override;
+
+    //各行计数器的最小值（估计值，不小于真实词频）
+    int count(WordId id) const override;
+
+    //由第一行的空计数器比例估计（线性计数），空计数器过少时偏低
+    size_t unique() const override;
+
+    size_t total() const override { return total_; }
+
+    //从候选中取估计词频最高的 K 个（按当前计数矩阵重新估计候选的词频）
+    void topK(size_t k, std::vector<std::pair<WordId, int>>& out) const override;
+
+    size_t memoryUsage() const override;
+
+    size_t width() const { return width_; }
+    size_t depth() const { return depth_; }
+    unsigned int paneSeconds() const { return pane_seconds_; }
+
+    //当前的误差上限：e / width * total
+    size_t errorBound() const;
+
+private:
+    //第 row 行中 id 对应的列
+    size_t column(size_t row, WordId id) const {
+        return static_cast<size_t>(((static_cast<uint64_t>(id) + 1) * seeds_[row]) >> shift_);
+    }
+
+    //一个时间段：[id * pane_seconds_, (id + 1) * pane_seconds_) 内写入的计数
+    struct Pane {
+        unsigned int id=0;
+        bool used=false;
+        size_t total=0;
+        std::vector<int> table;//与总矩阵同样大小，首次使用时分配，之后复用
+    };
+
+    //累加到总矩阵（pane 非空时同时累加到该段）
+    void addTo(int* pane, WordId id, int delta);
+
+    //取时间戳 ts 所属的时间段，必要时先淘汰占用该位置的旧段
+    Pane& paneFor(unsigned int ts);
+
+    //把一个时间段从总矩阵中减去并清空
+    void expirePane(Pane& pane);
+
+    //按当前计数矩阵重新估计所有候选，移出估计值为 0 的候选并重建堆
+    void refreshCandidates();
+
+    //更新候选堆中 id 的估计词频，必要时换入或移出
+    void updateCandidate(WordId id, int estimate);
+
+    void siftUp(uint32_t i);
+    void siftDown(uint32_t i);
+    void place(uint32_t i, const std::pair<WordId, int>& item) {
+        heap_[i] = item;
+        pos_[item.first] = i;
+    }
+    void removeAt(uint32_t i);
+
+    size_t width_;
+    size_t depth_;
+    unsigned int shift_;//64 - log2(width)，乘法哈希取高位
+    std::vector<uint64_t> seeds_;//每行一个奇数乘数
+    std::vector<int> table_;//depth_ x width_ 计数矩阵，按行存放
+    size_t zero_cells_;//第一行中为 0 的计数器数，用于估计不同词数
+    size_t total_=0;
+
+    unsigned int pane_seconds_=0;//每个时间段的秒数，0 表示不按时间段淘汰
+    std::vector<Pane> panes_;//时间段环形数组，下标为 段号 % 段数
+
+    size_t capacity_;//候选数上限
+    std::vector<std::pair<WordId, int>> heap_;//候选小顶堆，按估计词频
+    std::unordered_map<WordId, uint32_t> pos_;//词 ID -> heap_ 中的下标
+};
+
+#endif // COUNTMINCOUNTER_H
@@ -33,6 +33,8 @@ private:
     size_t low_watermark_;//剩余数据量阈值
     uint32_t window_size_;//滑动窗口大小（秒）
     size_t num_stat_threads_;//统计线程数量
+    size_t num_tokenizer_threads_;//分词工作线程数量
+    bool mask_sensitive_;//分词前是否屏蔽原文中的敏感词子串
     
     Buffer<TimeSlot> buffer_;//循环缓冲区（生产消费）
     SlidingWindow sliding_window_;//滑动窗口
@@ -52,7 +54,10 @@ public:
                   size_t buffer_capacity = 500,
                   size_t low_watermark = 100,
                   uint32_t window_size = 600,
-                  size_t num_stat_threads = 2);
+                  size_t num_stat_threads = 2,
+                  size_t num_tokenizer_threads = 0,
+                  const CounterOptions& counter_options = CounterOptions(),
+                  bool mask_sensitive = false);
     
     ~HotWordSystem();
     
@@ -4,18 +4,53 @@
 #include "Common.h"
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <iostream>
 using namespace std;
 
 
+/**
+ * 解析错误计数（格式不合法的行会被跳过并计数）
+ */
+struct InputParseStats {
+    size_t lines=0;//读取的总行数
+    size_t text_lines=0;//合法的文本行
+    size_t query_lines=0;//合法的查询行
+    size_t blank_lines=0;//空行
+    size_t malformed_timestamp=0;//缺少或非法的 [H:MM:SS] 前缀
+    size_t malformed_query=0;//非法的 [ACTION] QUERY K= 行
+    size_t out_of_order=0;//时间戳小于已读到的最大时间戳（被钳位）
+};
+
+/**
+ * 输入解析：逐行读取输入文件，解析时间戳、文本和查询命令
+ *
+ * 行格式（单次前向扫描解析，不使用正则、不分配内存）：
+ * - 文本行：[H:MM:SS] 文本
+ * - 查询行：[ACTION] QUERY K=数字
+ * 不符合格式的行记入 InputParseStats 并跳过
+ *
+ * 默认以 mmap 方式映射整个文件，用 memchr 查找换行符，
+ * 行和文本以 string_view 形式直接指向映射区，不做任何拷贝；
+ * 映射失败（如管道等非普通文件）时回退到 ifstream 逐行读取
+ */
 class InputHandler {
 private:
     std::string input_file_;//输入的文件
-    std::ifstream file_stream_;//文件读取
+    std::ifstream file_stream_;//文件读取（回退模式）
     unsigned int ts=0;
+
+    bool use_mmap_;//是否尝试 mmap
+    bool mapped_=false;//当前是否处于 mmap 模式
+    int fd_=-1;//映射文件的描述符
+    const char* data_=nullptr;//映射区起始地址
+    size_t size_=0;//映射区长度
+    size_t cursor_=0;//下一行的起始偏移
+    std::string line_;//回退模式下当前行的存储
+    InputParseStats stats_;//解析统计
     
 public:
-    InputHandler(const std::string& input_file);
+    InputHandler(const std::string& input_file, bool use_mmap = true);
     ~InputHandler();
     
     //打开文件
@@ -26,18 +61,41 @@ public:
 
     /**
      * 读取函数
-     * @return 是否成功读取并解析一行
+     * @return 是否成功读取并解析一行（空行和格式错误的行返回 false，并继续可读）
      */
     bool readLine(unsigned int& timestamp, std::string& text, 
                   bool& is_query, int& k);
 
+    /**
+     * 零拷贝读取：text 指向映射区（mmap 模式下在 close 之前一直有效）
+     * 回退模式下 text 指向内部行缓存，仅在下一次读取之前有效
+     * @return 是否成功读取并解析一行
+     */
+    bool readLine(unsigned int& timestamp, std::string_view& text,
+                  bool& is_query, int& k);
+
     //是否到达文件末尾
     bool eof() const;
+
+    //readLine 返回的 string_view 是否在 close 之前一直有效（即 mmap 模式）
+    bool mapped() const { return mapped_; }
+
+    //解析统计（含各类格式错误计数）
+    const InputParseStats& stats() const { return stats_; }
     
 private:
-    unsigned int parseTimestamp(const std::string& line);
-    string extractText(const string& line);
-    int parseQueryCommand(const std::string& line);
+    //映射整个文件，失败时返回 false
+    bool openMapped();
+
+    //取下一行（不含换行符）
+    bool nextLine(std::string_view& line);
+
+    /**
+     * 解析一行，单次前向扫描
+     * @return 行合法时返回 true；非法时更新错误计数并返回 false
+     */
+    bool parseLine(std::string_view line, unsigned int& timestamp,
+                   std::string_view& text, bool& is_query, int& k);
 };
 
 #endif 
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Buffer.h"
 #include "TextProcessor.h"
 #include "InputHandler.h"
+#include "TokenizerPool.h"
 #include <atomic>
 #include <memory>
 #include <queue>
@@ -12,6 +13,7 @@
 
 /**
  * 输入线程，负责读取、分词、写入 Buffer
+ * 分词交给 TokenizerPool 的多个工作线程并行完成，输入线程按原始顺序取回结果后写入
  */
 class InputThread {
 private:
@@ -23,25 +25,38 @@ private:
     std::mutex& query_mutex_;
     
     std::atomic<bool>& running_;//线程进行的标志
-    size_t batch_size_;//批量写入大小
+    size_t batch_size_;//每块提交给分词工作池的行数
+    size_t num_tokenizers_;//分词工作线程数（0 表示在输入线程内同步分词）
+    size_t pushed_slots_=0;//已写入 Buffer 的时间槽数，随查询一起入队
     
 public:
+    /**
+     * @param mask_sensitive 分词前屏蔽原文中的敏感词子串（传给 TextProcessor），默认关闭
+     */
     InputThread(const std::string& input_file,
                 Buffer<TimeSlot>& buffer,
                 std::queue<QueryCommand>& query_queue,
                 std::mutex& query_mutex,
                 std::atomic<bool>& running,
-                size_t batch_size = 50);
+                size_t batch_size = 50,
+                size_t num_tokenizers = 1,
+                bool mask_sensitive = false);
     
     /**
      * 线程主函数
      * 打开输入文件
-     * 逐行读取
-     * 处理查询命令
-     * 处理文本数据（解析+分词）
+     * 逐行读取，每 batch_size 行为一块提交给分词工作池
+     * 按提交顺序取回分词结果：文本写入 Buffer，查询在其之前的文本写入后才入队
      * 收尾
      */
     void run();
+
+private:
+    /**
+     * 按行顺序输出一块分词结果
+     * @return Buffer 已关闭时返回 false
+     */
+    bool emitChunk(TokenizerPool::Chunk& chunk, size_t& total_words);
 };
 
 #endif 
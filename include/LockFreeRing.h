@@ -0,0 +1,148 @@
+// 无锁环形队列（供 Buffer 的无锁模式使用，模板类）
+#ifndef LOCKFREERING_H
+#define LOCKFREERING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * 单生产者/单消费者环形队列
+ *
+ * head_ 只由消费者写，tail_ 只由生产者写，二者都是单调递增的计数，
+ * 下标为 计数 % 容量；各自缓存对方的计数，只有看起来满/空时才重新读取
+ */
+template<typename T>
+class SpscRing {
+private:
+    std::vector<T> slots_;
+    size_t capacity_;
+
+    alignas(64) std::atomic<size_t> head_{0};//消费者读位置
+    size_t cached_tail_=0;//消费者缓存的 tail_
+
+    alignas(64) std::atomic<size_t> tail_{0};//生产者写位置
+    size_t cached_head_=0;//生产者缓存的 head_
+
+public:
+    explicit SpscRing(size_t capacity) : slots_(capacity), capacity_(capacity) {}
+
+    //仅生产者调用；队列满时返回 false
+    bool tryPush(T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ >= capacity_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ >= capacity_) {
+                return false;
+            }
+        }
+        slots_[tail % capacity_] = std::move(item);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //仅消费者调用；队列空时返回 false
+    bool tryPop(T& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        item = std::move(slots_[head % capacity_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+};
+
+/**
+ * 有界多生产者/多消费者环形队列（Vyukov 算法）
+ *
+ * 每个槽带一个序号：序号 == 位置 表示可写，== 位置+1 表示可读，
+ * 读完后置为 位置+容量，供下一轮写入；生产者/消费者各自用 CAS 抢占位置
+ */
+template<typename T>
+class MpmcRing {
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t capacity_;
+
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+
+public:
+    explicit MpmcRing(size_t capacity) : cells_(new Cell[capacity]), capacity_(capacity) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    //队列满时返回 false
+    bool tryPush(T& item) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos % capacity_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(item);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    //队列空时返回 false
+    bool tryPop(T& item) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos % capacity_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (dif == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->data);
+        cell->seq.store(pos + capacity_, std::memory_order_release);
+        return true;
+    }
+
+    //近似元素数（包含正在写入/读取中的槽）
+    size_t size() const {
+        size_t deq = dequeue_pos_.load(std::memory_order_acquire);
+        size_t enq = enqueue_pos_.load(std::memory_order_acquire);
+        return enq > deq ? enq - deq : 0;
+    }
+};
+
+#endif // LOCKFREERING_H
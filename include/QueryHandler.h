@@ -2,35 +2,70 @@
 #define QUERYHANDLER_H
 
 #include "Common.h"
-#include <fstream>
-#include <sstream>
+#include <chrono>
 #include <mutex>
-#include <iomanip>
+#include <string>
 
+/**
+ * 查询结果输出
+ * 结果先格式化进一块复用的缓冲区（std::to_chars，不经过流），满足以下任一条件时才一次 write 写入文件：
+ * - 缓冲区达到 flush_bytes
+ * - 距上次写入超过 flush_interval_ms（只在下一次输出时检查，本身没有定时器）
+ * - 显式调用 flush()：统计线程在 Buffer 暂时为空、即将阻塞等待时调用，输入停顿后结果不会滞留到 join()；
+ *   所有线程结束时再调用一次落盘；或 close()
+ * 回放时大量查询集中触发，避免每个查询、每行都触发一次系统调用
+ */
 class QueryHandler {
 private:
     std::string output_file_;
-    std::ofstream file_stream_;
+    int fd_=-1;//输出文件描述符，未打开时为 -1
+    std::string buffer_;//待写入的结果
+    size_t flush_bytes_;//缓冲区写入阈值（字节）
+    std::chrono::milliseconds flush_interval_;//缓冲区写入间隔
+    std::chrono::steady_clock::time_point last_flush_;
     mutable std::mutex output_mutex_;
-    
+
 public:
-    QueryHandler(const std::string& output_file = "output.txt");
+    /**
+     * @param output_file 输出文件路径
+     * @param flush_bytes 缓冲区达到该大小时写入文件，0 表示每个查询都写入
+     * @param flush_interval_ms 距上次写入超过该时间时写入文件（在下一次 outputTopK 时检查）
+     */
+    QueryHandler(const std::string& output_file = "output.txt",
+                 size_t flush_bytes = 64 * 1024,
+                 unsigned int flush_interval_ms = 1000);
     ~QueryHandler();
-    
+
     bool open();
+
+    //写出缓冲区并关闭文件
     void close();
 
     /**
-     * 输出 Top-K 结果到文件
+     * 输出 Top-K 结果（写入缓冲区，按阈值写入文件）
+     * 词 ID 在这里经 WordDict 解析回字符串
      * @param timestamp 查询时刻的时间戳（秒）
-     * @param topk Top-K 词频列表（词 + 频次）
+     * @param topk Top-K 词频列表（词 ID + 频次）
      */
-    void outputTopK(unsigned int timestamp, 
-                    const std::vector<std::pair<std::string, int>>& topk);
-    
+    void outputTopK(unsigned int timestamp,
+                    const std::vector<std::pair<WordId, int>>& topk);
+
+    /**
+     * 把缓冲区中的结果写入文件
+     * @param sync 为 true 时再 fdatasync，保证已落盘
+     * @return 写入失败时返回 false
+     */
+    bool flush(bool sync = false);
+
 private:
-    //将时间戳（秒）格式化为 [HH:MM:SS]
-    std::string formatTimestamp(unsigned int seconds);
+    //将时间戳（秒）格式化为 [HH:MM:SS] 追加到缓冲区
+    void appendTimestamp(unsigned int seconds);
+
+    //追加十进制整数，width 为最少位数（不足补 0）
+    void appendNumber(long long value, int width = 0);
+
+    //调用方已持有 output_mutex_
+    bool flushLocked(bool sync);
 };
 
-#endif 
\ No newline at end of file
+#endif
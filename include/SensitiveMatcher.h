@@ -0,0 +1,123 @@
+// 敏感词子串匹配：字节级 Aho-Corasick 自动机
+#ifndef SENSITIVEMATCHER_H
+#define SENSITIVEMATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * 在原始文本上一次扫描找出所有敏感词出现的位置（不依赖分词结果）：
+ * - 加载阶段 add 所有敏感词，build 一次性编译成只读自动机
+ * - 转移按字节进行；UTF-8 是自同步编码，合法的模式串只会在字符边界上匹配
+ * - 节点的子节点按字节有序连续存放（CSR），根节点另有 256 项直接转移表
+ * - 每个状态记录以它结尾的最长模式串长度（含失配链上的），扫描时无需沿输出链回溯
+ * 扫描总步数不超过 2 * 文本长度，与词表大小、匹配数量无关
+ *
+ * build 之后只读，多线程并发扫描无需加锁。
+ */
+class SensitiveMatcher {
+public:
+    /**
+     * 加入一个模式串（build 之前调用）
+     * @param word 敏感词，空串忽略
+     */
+    void add(std::string_view word);
+
+    //编译自动机，之后的 add 需要再次 build 才生效
+    void build();
+
+    /**
+     * 把文本中所有命中敏感词的字节替换为 mask（偏移和长度保持不变）
+     * @return 是否有命中；没有命中时 text 原样不动
+     */
+    bool mask(std::string& text, char mask = ' ') const;
+
+    /**
+     * 只读扫描：若有命中，把原文复制到 out 并替换命中字节
+     * @return 是否有命中；没有命中时不复制，out 内容不确定
+     */
+    bool mask(std::string_view text, std::string& out, char mask = ' ') const;
+
+    //文本中是否包含任一敏感词
+    bool containsAny(std::string_view text) const;
+
+    //模式串个数（去重后）
+    size_t size() const { return patterns_; }
+
+    //自动机状态数
+    size_t states() const { return fail_.size(); }
+
+    //自动机占用的内存（字节）
+    size_t memoryUsage() const;
+
+private:
+    //状态 s 经字节 c 的 goto 转移，不存在时返回 0（根）
+    uint32_t child(uint32_t s, uint8_t c) const {
+        if (s == 0) {
+            return root_next_[c];
+        }
+        uint32_t lo = child_begin_[s], hi = child_begin_[s + 1];
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) >> 1;
+            if (child_keys_[mid] < c) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo < child_begin_[s + 1] && child_keys_[lo] == c ? child_nodes_[lo] : 0;
+    }
+
+    //完整转移：goto 失败时沿失配链回退
+    uint32_t next(uint32_t s, uint8_t c) const {
+        while (true) {
+            uint32_t t = child(s, c);
+            if (t != 0 || s == 0) {
+                return t;
+            }
+            s = fail_[s];
+        }
+    }
+
+    /**
+     * 扫描文本，对每个命中区间 [begin, end) 调用 f
+     * 区间按 end 递增给出，每个结束位置只给出最长的命中
+     */
+    template<typename F>
+    void scan(std::string_view text, F&& f) const {
+        if (patterns_ == 0) {
+            return;
+        }
+        uint32_t s = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            s = next(s, static_cast<uint8_t>(text[i]));
+            if (out_len_[s] != 0) {
+                if (!f(i + 1 - out_len_[s], i + 1)) {
+                    return;
+                }
+            }
+        }
+    }
+
+    //扫描得到的命中区间（线程局部缓冲，下次调用前有效）
+    const std::vector<std::pair<size_t, size_t>>& hits(std::string_view text) const;
+
+    //把命中区间的并集替换为 mask
+    static void fill(char* data, const std::vector<std::pair<size_t, size_t>>& found, char mask);
+
+    std::vector<std::string> pending_;//所有模式串，build 时排序去重并编译，再次 build 时与新加入的词一起重新编译
+
+    uint32_t root_next_[256]={};//根节点的直接转移表
+    std::vector<uint32_t> child_begin_;//状态 s 的子节点位于 [child_begin_[s], child_begin_[s+1])
+    std::vector<uint8_t> child_keys_;//子节点对应的字节（每个状态内有序）
+    std::vector<uint32_t> child_nodes_;//子节点状态号
+    std::vector<uint32_t> fail_;//失配链
+    std::vector<uint32_t> out_len_;//以该状态结尾的最长模式串长度，0 表示无输出
+    size_t patterns_=0;
+};
+
+#endif // SENSITIVEMATCHER_H
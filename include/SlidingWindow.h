@@ -2,9 +2,11 @@
 #define SLIDINGWINDOW_H
 
 #include "Common.h"
-#include <unordered_map>
-#include <map>
+#include "WordCounter.h"
+#include "WindowBatch.h"
 #include <mutex>
+#include <atomic>
+#include <memory>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -12,88 +14,205 @@ using namespace std;
 
 class SlidingWindow {
 private:
-    unordered_map<string, int> word_count_;
-    map<unsigned int, vector<string>> time_index_;
+    /**
+    * 每秒一个桶，保存该秒内预聚合的 (词 ID, 次数) 增量
+    * 淘汰时按桶整体减去，代价与该秒的不同词数成正比
+    */
+    struct SecondBucket {
+        unsigned int timestamp=0;//桶对应的时间戳
+        bool used=false;//是否存有未淘汰的数据
+        vector<pair<WordId,int>> deltas;//该秒内各词的出现次数（clear 后保留容量，稳态无分配）
+    };
+
+    /**
+    * 分片（子窗口）：词按 WordId % 分片数 划分到各分片，
+    * 每个分片独立加锁、独立计数和淘汰，多个统计线程可以并行写入不同分片。
+    * 分片内部使用局部 ID（WordId / 分片数），保证各数组稠密。
+    */
+    struct Shard {
+        unique_ptr<WordCounter> word_count_;//词频统计（按局部 ID）：精确模式为词频表 + Top-K 索引堆，近似模式为按时间段淘汰的 Count-Min Sketch + 候选堆
+        vector<SecondBucket> time_ring_;//定长环形数组，共 window_size_+1 个桶，下标为 timestamp % 桶数；近似模式由 word_count_ 自行淘汰，为空
+        vector<unsigned int> last_ts_;//局部 ID -> 最近一次写入的桶时间戳，用于桶内聚合（近似模式不使用）
+        vector<uint32_t> last_slot_;//局部 ID -> 该词在最近写入的桶 deltas 中的下标（近似模式不使用）
+        unsigned int next_expire_=0;//下一个待淘汰的时间戳（之前的秒已全部淘汰）
+        mutable mutex mutex_;
+
+        Shard(unsigned int window_size, const CounterOptions& counter)
+            :word_count_(makeWordCounter(counter, window_size)),
+             time_ring_(word_count_->windowed() ? 0 : window_size + 1){}
+    };
+
+    vector<unique_ptr<Shard>> shards_;//分片列表，创建后数量不变
     unsigned int window_size_;
-    unsigned int max_event_time=0;//最大事件时间，即确保没有迟到的数据比其先到
+    atomic<unsigned int> max_event_time{0};//最大事件时间，即确保没有迟到的数据比其先到
     unsigned int max_delay_=60;//允许迟到1分钟
-    map<unsigned int,vector<string>> delayed_buffer_;//延迟数据缓冲区
-    mutable mutex mutex_;
-    
+    atomic<size_t> slots_added_{0};//已合并的时间槽数（含因迟到被丢弃的），用于判断查询之前的数据是否已全部到达
+    atomic<uint64_t> version_{0};//窗口版本号，每次写入或淘汰改变了词频后递增
+
+    /**
+    * 只读快照：写入方只递增版本号；查询方发现快照落后于版本号时才重建并发布（同一时刻只有一个查询方重建），
+    * 其余查询方原子地取得指针后直接读取，不加分片锁
+    * 快照一经发布不再修改，旧快照在最后一个读者释放后回收（shared_ptr 引用计数）
+    */
+    struct Snapshot {
+        uint64_t version=0;//快照对应的窗口版本（包含版本号不大于它的所有写入）
+        size_t total=0;//窗口内的总词数
+        size_t unique=0;//窗口内的不同词数
+        size_t k=0;//topk 按该 K 计算
+        vector<pair<WordId,int>> topk;//按词频降序，size < k 时表示已包含窗口内全部词
+    };
+    mutable shared_ptr<const Snapshot> snapshot_;//当前快照，只通过 std::atomic_load / atomic_compare_exchange 访问
+    atomic<size_t> snapshot_k_{0};//快照中保存的 Top-K 长度，取查询中出现过的最大 K
+    mutable atomic<bool> rebuilding_{false};//是否已有查询方在重建快照（CAS 抢占，保证只重建一次）
+
 public:
 
     /**
     * 构造函数
     * @param window_size 滑动窗口大小（秒），默认 600 秒（10 分钟）
     * @param max_delay 最大延迟时间（秒），默认 60 秒（1 分钟）
+    * @param num_shards 分片数，默认 1（多个统计线程时按线程数放大以减少锁竞争）
+    * @param counter 词频统计方式，默认精确计数；近似模式的计数矩阵大小固定，词频与 Top-K 为估计值（误差上限见 CounterOptions），
+    *                窗口按时间段整段淘汰、不保存逐词增量，窗口状态的内存与不同词数无关
     */
-    explicit SlidingWindow(unsigned int window_size = 600,unsigned int max_delay=60);
+    explicit SlidingWindow(unsigned int window_size = 600,unsigned int max_delay=60,size_t num_shards=1,
+                           const CounterOptions& counter = CounterOptions());
     
     /**
     * 向滑动窗口中加入一个时间槽的数据
     *
     * 逻辑说明：
-    * 1. 将当前 TimeSlot 中的所有词加入词频统计表 word_count_
-    * 2. 在 time_index_ 中记录该时间戳对应的词列表
-    * 3. 根据当前时间戳，淘汰窗口外（超过 window_size）的旧数据
+    * 1. 推进全局最大事件时间，时间前进时各分片淘汰窗口外（超过 window_size）的旧数据
+    * 2. 将当前 TimeSlot 中的词 ID 按分片拆分，逐个分片加锁写入词频统计表
+    * 3. 在该秒对应的环形桶中累加 (词 ID, 次数)
+    *
+    * 可被多个统计线程并发调用，只锁涉及的分片
+    * 迟到数据（不超过 max_delay 且仍在窗口内）直接写入其所属秒的桶
     *
-    * @param data 已完成分词的时间槽（时间戳 + 词列表）
+    * @param data 已完成分词的时间槽（时间戳 + 词 ID 列表）
     */
     void addData(const TimeSlot& data);
 
+    /**
+    * 合并统计线程本地预聚合的一个微批
+    *
+    * 与按顺序对批内每个 TimeSlot 调用 addData 等价，但每个分片只加一次锁，
+    * 每个 (秒, 词) 只更新一次词频
+    *
+    * @param batch 已按秒聚合的 (词 ID, 次数) 增量
+    */
+    void addBatch(const WindowBatch& batch);
+
     /**
     * 获取当前窗口内 Top-K 高频词
     *
     * 实现方式：
-    * - 将 unordered_map 转为 vector
-    * - 按词频降序排序
-    * - 取前 K 个
+    * - 各分片的 word_count_ 在 addData / decrementWord 时已增量维护按词频排序的堆
+    * - 每个分片只从堆顶向下取前 K 个候选，代价 O(K log K)，与窗口内词表大小无关
+    * - 分片间词互不重叠，合并各分片候选后再取前 K 个即为全局 Top-K
+    *
+    * 快照是最新版本且覆盖本次 K（K 不小于本次 K，或已包含全部词）时直接取前缀，不阻塞写入；
+    * 否则由一个查询方逐个分片加锁重建并发布，之后的快照都按出现过的最大 K 保存
     *
     * @param k Top-K 中的 K 值
-    * @return 词频对 (word, count) 的列表
+    * @return 词频对 (word id, count) 的列表，输出时再经 WordDict 解析为字符串
+    */
+    vector<pair<WordId, int>> getTopK(int k);
+
+    /**
+    * 窗口版本号：单调递增，每次 addData / addBatch 改变了窗口内容后加一
+    * 版本号相同的两次读取之间窗口内容没有变化
     */
-    vector<pair<string, int>> getTopK(int k);
+    uint64_t version() const;
     
     /**
     * 获取某个词在当前窗口内的出现次数
+    * 快照只保存 Top-K，单个词仍读分片词频表：只锁该词所在的一个分片，持锁时间 O(1)
     */
     int getWordCount(const string& word) const;
+    int getWordCount(WordId id) const;
 
     /**
-    * 获取窗口内的总词数（含重复）
+    * 获取窗口内的总词数（含重复），从当前快照读取；快照落后于窗口版本时先重建
     */
     size_t getTotalWords() const;
 
     /**
-    * 获取窗口内的不同词数量
+    * 获取窗口内的不同词数量，从当前快照读取；快照落后于窗口版本时先重建
     */
     size_t getUniqueWords() const;
 
     unsigned int currentTime() const;
 
+    //已合并（或因迟到丢弃）的时间槽总数
+    size_t slotsAdded() const;
+
     //内存占用
     size_t estimateMemoryUsage() const;
     
 private:
 
     /**
-    * 淘汰滑动窗口外的过期数据
+    * 把同一时间戳、同一分片的一组词写入分片（调用方不持锁）
+    * @param local_ids 分片内局部 ID
+    */
+    void addToShard(Shard& shard, const vector<WordId>& local_ids, unsigned int ts, unsigned int now);
+
+    /**
+    * 淘汰分片内滑动窗口外的过期数据（调用方持有分片锁）
     *
     * 规则：
     * - 若某个时间戳 < current_time - window_size_
-    * - 则该时间槽内的所有词都需要从 word_count_ 中减去
+    * - 则该秒的桶整体从 word_count_ 中减去
+    * - 从 next_expire_ 起逐秒推进，每秒只处理一个桶
+    * - 跨度超过一整圈时改为扫描全部桶一次，淘汰所有时间戳早于淘汰线的桶
     *
     * @param max_event_time 当前最新数据的时间戳
     */
-    void evictExpiredData(unsigned int max_event_time);
+    void evictExpiredData(Shard& shard, unsigned int max_event_time);
+
+    //把一个桶整体从 word_count_ 中减去并清空（调用方持有分片锁）
+    void evictBucket(Shard& shard, SecondBucket& bucket);
+
+    /**
+    * 对某个词进行词频递减，若减到 0 则移出 Top-K 索引
+    * @param count 递减的次数（桶内聚合后的次数）
+    */
+    void decrementWord(Shard& shard, WordId local_id, int count);
+
+    //对某个词进行词频递增，并记入时间戳 ts 所在的桶
+    void incrementWord(Shard& shard, WordId local_id, unsigned int ts, int count=1);
+
+    //推进最大事件时间（CAS 取最大值），返回推进后的值
+    unsigned int advanceTime(unsigned int ts, bool& advanced);
+
+    //时间前进时让所有分片同步淘汰
+    void evictAllShards(unsigned int now);
+
+    //取时间戳 ts 对应的桶，必要时重置为该秒（桶中残留的旧数据先淘汰）
+    SecondBucket& bucketFor(Shard& shard, unsigned int ts);
+
+    /**
+    * 逐个分片加锁，计算窗口版本 version 的快照（Top-K 候选与计数在同一次加锁中取得）
+    * @param k 快照中保存的 Top-K 长度
+    */
+    shared_ptr<Snapshot> buildSnapshot(uint64_t version, size_t k) const;
+
+    /**
+    * 发布快照：仅当它比当前快照新（版本更高，或同版本下 K 更大）时替换
+    * 版本较旧的快照不会覆盖较新的
+    */
+    void publishSnapshot(shared_ptr<const Snapshot> snap) const;
 
     /**
-    * 对某个词进行词频递减，若减到 0 则删除
+    * 取得包含当前窗口版本、且 Top-K 覆盖 want 的快照
+    * 快照已满足时直接返回；否则 CAS 抢到重建权的查询方重建并发布一次，其余查询方等待它发布后重新检查
+    * @param hit 输出：是否直接命中已发布的快照
     */
-    void decrementWord(const string& word);
+    shared_ptr<const Snapshot> currentSnapshot(size_t want, bool& hit) const;
 
-    //处理过旧数据
-    void processDelayedData();
+    //写入方改变窗口后调用：只递增版本号，快照由之后的查询按需重建
+    void commitVersion();
 };
 
 #endif 
\ No newline at end of file
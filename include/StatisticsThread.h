@@ -4,15 +4,17 @@
 #include "Common.h"
 #include "Buffer.h"
 #include "SlidingWindow.h"
+#include "WindowBatch.h"
 #include "QueryHandler.h"
 #include <atomic>
 #include <memory>
 #include <queue>
 #include <mutex>
+#include <chrono>
 
 /**
  * get TimeSlot from buffer
- * call addData to add TimeSlot to SlidingWindow
+ * pre-aggregate TimeSlots into a thread-local WindowBatch, merge it into SlidingWindow with addBatch
  * check QueryCommand and cout TopK
  */
 class StatisticsThread {
@@ -24,6 +26,11 @@ private:
     
     std::queue<QueryCommand>& query_queue_;//保存查询请求
     std::mutex& query_mutex_;
+
+    WindowBatch batch_;//线程本地预聚合的微批
+    size_t batch_slots_;//微批最多累积的 TimeSlot 数
+    double max_batch_delay_ms_;//微批最长滞留时间（毫秒），限制查询看到的数据延迟
+    std::chrono::high_resolution_clock::time_point batch_start_;//当前微批第一条数据的时间
     
 public:
     //线程初始化
@@ -32,19 +39,31 @@ public:
                      SlidingWindow& sliding_window,
                      QueryHandler& query_handler,
                      std::queue<QueryCommand>& query_queue,
-                     std::mutex& query_mutex);
+                     std::mutex& query_mutex,
+                     size_t batch_slots = 64,
+                     unsigned int max_batch_delay_ms = 20);
     
     /**
      * 核心主循环
-     * 从buffer_在获取TimeSlot
-     * 更新SlidingWindow中的词频统计
-     * 根据当前时间处理查询TopK
+     * 从buffer_在获取TimeSlot，累积到本地微批
+     * 以下任一条件满足时把微批合并进SlidingWindow并处理查询：
+     * - 微批达到 batch_slots_ 个 TimeSlot
+     * - 微批滞留超过 max_batch_delay_ms_
+     * - 有查询的时间戳已被微批覆盖（保证查询结果包含该时刻之前的数据）
+     * - 缓冲区暂时为空或输入结束
+     * 缓冲区暂时为空、即将阻塞等待时，还会把 QueryHandler 中缓冲的结果写入文件
      */
     void run();
     
 private:
     //执行查询（工具函数）
     void processQueries();
+
+    //把本地微批合并进窗口，返回耗时（毫秒）
+    double flushBatch();
+
+    //队首查询是否可以执行：时间戳不晚于 ts，且其之前的时间槽都已在窗口或本地微批中
+    bool queryDue(unsigned int ts);
 };
 
 #endif
@@ -2,34 +2,47 @@
 #define TEXTPROCESSOR_H
 
 #include "Common.h"
+#include "WordFilter.h"
+#include "SensitiveMatcher.h"
 #include "../cppjieba/Jieba.hpp"
 #include <unordered_set>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace cppjieba {
     class Jieba;
 }
 
+//词典目录下的二进制词典快照文件名
+constexpr const char* DICT_SNAPSHOT_FILE = "jieba.snapshot.bin";
+
 /**
  * 中文分词 + 停用词过滤 + 词语清洗
  */
 class TextProcessor {
 private:
     std::unique_ptr<cppjieba::Jieba> jieba_;
-    std::unordered_set<std::string> stop_words_;//基于哈希的停用词表，实现O(1)查找
-    std::unordered_set<std::string> sensitive_words_;  // 敏感词表
-    std::unordered_set<std::string> valid_pos_;        // 有效词性集合
+    WordFilter word_filter_;//停用词 + 敏感词表，加载后编译为布隆预过滤 + 扁平哈希表，一次查找得到两种标记
+    std::unordered_set<std::string> valid_pos_;        // 有效词性集合（仅在加载和运行时新增词性时使用）
+    std::vector<uint64_t> valid_pos_mask_;              // 按 jieba 词性 ID 索引的有效位图，由 valid_pos_ 生成
+    size_t pos_mask_tags_=0;                            // 位图覆盖的词性 ID 数（加载时的词性总数）
     bool enable_pos_filter_;                            // 是否启用词性过滤
+    SensitiveMatcher sensitive_matcher_;                // 敏感词子串匹配自动机，仅在启用屏蔽时构建
+    bool mask_sensitive_;                               // 分词前是否屏蔽原文中的敏感词子串
 
 public:
 
     /**
      * 构造函数
      * @param dict_path 词典目录路径（默认 "dict/"）
+     * @param enable_pos_filter 是否启用词性过滤
+     * @param mask_sensitive 分词前在原文中屏蔽敏感词子串（不论分词如何切分都不会漏过）
+     *                       敏感词表含有大量常用词，默认关闭，只按整词过滤
      */
-    TextProcessor(const std::string& dict_path = "../dict/", bool enable_pos_filter=false);
+    TextProcessor(const std::string& dict_path = "../dict/", bool enable_pos_filter=false,
+                  bool mask_sensitive=false);
 
     ~TextProcessor();
     
@@ -38,7 +51,7 @@ public:
      * @param text 原始文本
      * @return 处理后的词语列表
      */
-    std::vector<std::string> process(const std::string& text);
+    std::vector<std::string> process(const std::string& text) const;
     
     /**
      * 带词性的处理函数
@@ -46,7 +59,15 @@ public:
      * @param text 原始文本
      * @return 处理后的词语列表
      */
-    std::vector<std::string> processWithPOS(const std::string& text);
+    std::vector<std::string> processWithPOS(const std::string& text) const;
+
+    /**
+     * 带词性处理，并把结果词驻留为 WordDict 中的 ID
+     * 输入线程使用该接口，之后的统计链路只传递 ID
+     * @param text 原始文本（可直接指向 InputHandler 的映射区）
+     * @return 处理后的词 ID 列表
+     */
+    std::vector<WordId> processWithPOSToIds(std::string_view text) const;
 
 private:
    /**
@@ -54,23 +75,44 @@ private:
     */
     void loadStopWords(const std::string& file_path);
 
-    //加载有效词性
-    void initValidPOS();
+    /**
+     * 加载有效词性：每行一个词性标记，# 之后为注释
+     * 文件不存在时使用内置的默认列表
+     */
+    void initValidPOS(const std::string& file_path);
+
+    //按 jieba 的词性 ID 把有效词性展开成位图
+    void buildPOSMask();
 
     //加载敏感词
     void loadSensitiveWords(const std::string& file_path);
 
+    /**
+     * 一次扫描原文，把命中敏感词的字节替换为空格（偏移不变，空格在过滤时被丢弃）
+     * @return 未启用或没有命中时为原文；否则为线程局部的屏蔽副本（下次调用前有效）
+     */
+    std::string_view maskSensitive(std::string_view text) const;
+
+    /**
+     * 分词并标注词性，结果以 (偏移, 长度, 词性 ID) 写入线程局部缓冲
+     * @return 分词结果（下次调用前有效）；分词失败时为空
+     */
+    const std::vector<cppjieba::TagSpan>& tagSpans(std::string_view text) const;
+
     //判断是否为停用词
-    bool isStopWord(const std::string& word) const;
+    bool isStopWord(std::string_view word) const;
 
     //判断是否为敏感词
-    bool isSensitiveWord(const std::string& word) const;
+    bool isSensitiveWord(std::string_view word) const;
 
     //判断词性是否有效
     bool isValidPOS(const std::string& pos) const;
 
+    //按词性 ID 判断词性是否有效
+    bool isValidPOS(uint32_t tag_id) const;
+
     //判断词是否有效
-    bool isValidWord(const std::string &word) const;
+    bool isValidWord(std::string_view word) const;
 };
 
 #endif
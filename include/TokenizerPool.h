@@ -0,0 +1,104 @@
+#ifndef TOKENIZERPOOL_H
+#define TOKENIZERPOOL_H
+
+#include "Common.h"
+#include "TextProcessor.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * 输入文件中的一行（已解析，尚未分词）
+ * mmap 模式下 view 直接指向映射区；回退模式下文本拷贝到 owned 中
+ */
+struct InputLine {
+    unsigned int timestamp=0;//时间戳
+    bool is_query=false;//是否为查询命令
+    int k=0;//查询的 K 值
+    std::string_view view;//指向 InputHandler 映射区的文本
+    std::string owned;//回退模式下持有的文本拷贝（非空时优先使用）
+
+    std::string_view text() const { return owned.empty() ? view : std::string_view(owned); }
+};
+
+/**
+ * 分词工作池：位于 InputHandler 与 Buffer<TimeSlot> 之间
+ *
+ * - 输入线程按行读取，凑满一块（chunk）后 submit 给工作池
+ * - 多个工作线程共享同一个 TextProcessor（其中的 Jieba 只读），并行分词
+ * - next() 严格按提交顺序取回已完成的块，保证写入滑动窗口的时间顺序、
+ *   以及查询与文本行的相对顺序和单线程时完全一致
+ *
+ * 工作线程数为 0 时退化为在 submit 中同步分词，不创建线程
+ */
+class TokenizerPool {
+public:
+    /**
+     * 一块输入行及其分词结果
+     */
+    struct Chunk {
+        std::vector<InputLine> lines;//按原始顺序的输入行
+        std::vector<std::vector<WordId>> words;//words[i] 为 lines[i] 的分词结果（查询行为空）
+        double process_ms=0.0;//该块的分词耗时
+        bool done=false;//是否已完成分词
+    };
+
+    /**
+     * @param text_processor 共享的分词器，调用方保证其生命周期长于工作池
+     * @param num_workers 工作线程数
+     * @param max_in_flight 最多同时在途的块数（限制内存），为 0 时取 2 倍工作线程数
+     */
+    TokenizerPool(const TextProcessor& text_processor, size_t num_workers, size_t max_in_flight = 0);
+
+    ~TokenizerPool();
+
+    TokenizerPool(const TokenizerPool&) = delete;
+    TokenizerPool& operator=(const TokenizerPool&) = delete;
+
+    /**
+     * 提交一块输入行，交由工作线程分词
+     * 调用方应在 full() 时先用 next() 取回最早的块，避免在途数据无限增长
+     */
+    void submit(std::vector<InputLine>&& lines);
+
+    /**
+     * 阻塞等待最早提交的块分词完成并取出
+     * @return 没有在途块时返回 false
+     */
+    bool next(Chunk& out);
+
+    //在途块数是否已达上限
+    bool full() const;
+
+    //在途（已提交未取回）的块数
+    size_t pending() const;
+
+    size_t workerCount() const { return workers_.size(); }
+
+private:
+    //工作线程主函数：取块、分词、标记完成
+    void workerLoop();
+
+    //对一块输入行分词
+    void tokenize(Chunk& chunk);
+
+    const TextProcessor& text_processor_;
+    size_t max_in_flight_;
+
+    std::deque<std::shared_ptr<Chunk>> in_flight_;//按提交顺序排列的在途块
+    std::deque<std::shared_ptr<Chunk>> todo_;//等待工作线程领取的块
+    bool stopping_=false;
+
+    mutable std::mutex mutex_;
+    std::condition_variable todo_cv_;//有新块可领取
+    std::condition_variable done_cv_;//有块完成分词
+
+    std::vector<std::thread> workers_;
+};
+
+#endif
@@ -0,0 +1,70 @@
+// 词频表 + 按词频排序的索引堆（增量维护 Top-K）
+#ifndef TOPKCOUNTER_H
+#define TOPKCOUNTER_H
+
+#include "Common.h"
+#include "WordCounter.h"
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+/**
+ * 以 WordId 为下标的词频表，同时维护一个按词频排序的大顶堆
+ * （带位置索引，可对任意词做 +delta / -delta 并就地调整）。
+ *
+ * 复杂度：
+ * - add：O(log V)
+ * - topK：只在堆顶附近做最佳优先搜索，O(K log K)，与词表大小 V 无关
+ *
+ * 非线程安全，由外层（SlidingWindow）加锁。
+ */
+class TopKCounter final : public WordCounter {
+private:
+    static constexpr uint32_t NPOS = 0xffffffffu;
+
+    std::vector<int> count_;       // WordId -> 词频
+    std::vector<uint32_t> pos_;    // WordId -> heap_ 中的下标，NPOS 表示不在堆中
+    std::vector<WordId> heap_;     // 大顶堆，只包含词频大于 0 的词
+    size_t total_ = 0;             // 词频总和
+
+public:
+    /**
+     * 调整某个词的词频
+     * @param id 词 ID
+     * @param delta 增量，可为负；减到 0 时从堆中移除
+     */
+    void add(WordId id, int delta) override;
+
+    //某个词当前的词频
+    int count(WordId id) const override;
+
+    //词频大于 0 的词数
+    size_t unique() const override { return heap_.size(); }
+
+    //词频总和（含重复）
+    size_t total() const override { return total_; }
+
+    /**
+     * 取词频最高的 K 个词，按词频降序写入 out
+     * @param k Top-K 中的 K 值
+     * @param out 输出 (word id, count) 列表（会被清空）
+     */
+    void topK(size_t k, std::vector<std::pair<WordId, int>>& out) const override;
+
+    //内存占用估算（字节）
+    size_t memoryUsage() const override;
+
+private:
+    bool higher(uint32_t a, uint32_t b) const {
+        return count_[heap_[a]] > count_[heap_[b]];
+    }
+    void place(uint32_t i, WordId id) {
+        heap_[i] = id;
+        pos_[id] = i;
+    }
+    void siftUp(uint32_t i);
+    void siftDown(uint32_t i);
+    void remove(WordId id);
+};
+
+#endif // TOPKCOUNTER_H
@@ -0,0 +1,55 @@
+// 统计线程本地的窗口增量（微批）
+#ifndef WINDOWBATCH_H
+#define WINDOWBATCH_H
+
+#include "Common.h"
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+/**
+ * 统计线程在本地把若干个 TimeSlot 预聚合为 (秒 -> 词 -> 次数) 的增量，
+ * 攒够一个微批后再由 SlidingWindow::addBatch 一次性合并进窗口，
+ * 从而把“每行加一次锁、每个词一次哈希”降为“每批每分片加一次锁、每个不同词一次更新”。
+ *
+ * 非线程安全，每个统计线程持有自己的实例；clear 后保留容量，稳态无分配。
+ */
+class WindowBatch {
+public:
+    //某一秒内聚合后的增量
+    struct Second {
+        unsigned int timestamp=0;
+        std::vector<std::pair<WordId,int>> deltas;//(词 ID, 次数)
+    };
+
+private:
+    std::vector<Second> seconds_;//按到达顺序排列，前 used_ 项有效；某秒之后出现过更晚的时间戳时，同一时间戳会另起一项
+    size_t used_=0;
+    std::vector<uint32_t> last_second_;//WordId -> 最近写入的 seconds_ 下标
+    std::vector<uint32_t> last_slot_;//WordId -> 在该秒 deltas 中的下标
+    size_t slot_count_=0;//已累积的 TimeSlot 数
+    size_t word_count_=0;//已累积的词数（含重复）
+    unsigned int max_timestamp_=0;
+
+public:
+    //累积一个时间槽
+    void add(const TimeSlot& slot);
+
+    //清空（保留容量）
+    void clear();
+
+    bool empty() const { return slot_count_ == 0; }
+    size_t slotCount() const { return slot_count_; }
+    size_t wordCount() const { return word_count_; }
+    unsigned int maxTimestamp() const { return max_timestamp_; }
+
+    //有效的秒数及访问
+    size_t secondCount() const { return used_; }
+    const Second& second(size_t i) const { return seconds_[i]; }
+
+private:
+    //取时间戳 ts 对应的秒（不存在、或其后已有更晚的秒时追加），返回下标
+    size_t secondFor(unsigned int ts);
+};
+
+#endif // WINDOWBATCH_H
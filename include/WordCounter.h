@@ -0,0 +1,79 @@
+// 窗口词频统计的公共接口：精确计数与近似计数
+#ifndef WORDCOUNTER_H
+#define WORDCOUNTER_H
+
+#include "Common.h"
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * 滑动窗口分片内的词频统计：写入时 +delta，淘汰时按桶 -delta，查询时取 Top-K
+ * - TopKCounter：精确计数，内存随词表增长
+ * - CountMinCounter：近似计数（Count-Min Sketch + 候选堆），按时间段保存计数矩阵并整段淘汰，内存固定
+ *
+ * 非线程安全，由外层（SlidingWindow）加锁。
+ */
+class WordCounter {
+public:
+    virtual ~WordCounter() = default;
+
+    /**
+     * 调整某个词的词频
+     * @param id 词 ID
+     * @param delta 增量，可为负（淘汰时减去之前加入的次数）
+     */
+    virtual void add(WordId id, int delta) = 0;
+
+    //某个词当前的词频（近似模式下为估计值）
+    virtual int count(WordId id) const = 0;
+
+    //词频大于 0 的词数（近似模式下为估计值）
+    virtual size_t unique() const = 0;
+
+    //词频总和（含重复）
+    virtual size_t total() const = 0;
+
+    /**
+     * 取词频最高的 K 个词，按词频降序写入 out
+     * @param k Top-K 中的 K 值
+     * @param out 输出 (word id, count) 列表（会被清空）
+     */
+    virtual void topK(size_t k, std::vector<std::pair<WordId, int>>& out) const = 0;
+
+    //内存占用估算（字节）
+    virtual size_t memoryUsage() const = 0;
+
+    /**
+     * 是否自行按时间段淘汰（近似模式）
+     * 为 true 时滑动窗口不再按秒保存逐词增量：写入调用 addAt，淘汰调用 expireBefore
+     */
+    virtual bool windowed() const { return false; }
+
+    //把时间戳 ts 的增量计入其所属的时间段（windowed() 为 true 时使用）
+    virtual void addAt(unsigned int ts, WordId id, int delta) { (void)ts; add(id, delta); }
+
+    //淘汰所有整段早于 expire_time 的时间段（windowed() 为 true 时使用）
+    virtual void expireBefore(unsigned int expire_time) { (void)expire_time; }
+};
+
+/**
+ * 词频统计方式
+ * 近似模式的误差：count 不小于真实值，且以至少 1 - delta 的概率不超过 真实值 + epsilon * total
+ */
+struct CounterOptions {
+    bool approximate=false;//false 为精确计数（TopKCounter），true 为近似计数（CountMinCounter）
+    double epsilon=0.0001;//近似模式的相对误差上限（相对于窗口内总词数）
+    double delta=0.01;//近似模式下超出误差上限的概率
+    size_t heavy_hitters=1024;//近似模式保留的候选高频词数，应不小于查询中的最大 K
+    size_t panes=10;//近似模式把窗口分成的时间段数：每段一个计数矩阵，整段淘汰，窗口最多多保留一段的时长
+};
+
+/**
+ * 按配置创建分片使用的词频统计
+ * @param window_size 滑动窗口大小（秒），近似模式据此划分时间段
+ */
+std::unique_ptr<WordCounter> makeWordCounter(const CounterOptions& options, unsigned int window_size);
+
+#endif // WORDCOUNTER_H
@@ -0,0 +1,58 @@
+// 词典：字符串驻留（string interning），词 <-> 稠密 32 位 ID
+#ifndef WORDDICT_H
+#define WORDDICT_H
+
+#include "Common.h"
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 全局词典，分词时把每个词映射为一个稠密 ID，之后的缓冲区、
+ * 滑动窗口只传递和统计 ID，只有输出结果时才解析回字符串。
+ *
+ * 线程安全：查找走读锁，首次出现的新词才加写锁插入。
+ * 词串存放在 deque 中，插入不会使已有引用失效，ID 一经分配永不回收。
+ */
+class WordDict {
+private:
+    std::deque<std::string> words_;                            // ID -> 词（下标即 ID）
+    std::unordered_map<std::string_view, WordId> ids_;         // 词 -> ID，key 指向 words_ 中的字符串
+    mutable std::shared_mutex mutex_;
+
+    WordDict() = default;
+
+public:
+    WordDict(const WordDict&) = delete;
+    WordDict& operator=(const WordDict&) = delete;
+
+    //进程内唯一实例
+    static WordDict& instance();
+
+    /**
+     * 获取词对应的 ID，不存在则分配新 ID
+     * @param word 词
+     * @return 稠密 ID（从 0 开始连续分配）
+     */
+    WordId intern(std::string_view word);
+
+    //批量驻留（与 intern 分开命名，避免 intern({"x"}) 的重载歧义）
+    std::vector<WordId> internAll(const std::vector<std::string>& words);
+
+    /**
+     * 只查找不插入
+     * @return 是否存在
+     */
+    bool find(std::string_view word, WordId& id) const;
+
+    //ID -> 词，ID 必须由 intern 分配
+    const std::string& word(WordId id) const;
+
+    //已分配的 ID 数量
+    size_t size() const;
+};
+
+#endif // WORDDICT_H
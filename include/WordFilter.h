@@ -0,0 +1,101 @@
+// 停用词 / 敏感词过滤表：布隆预过滤 + 扁平开放寻址哈希表
+#ifndef WORDFILTER_H
+#define WORDFILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * 加载阶段 add 所有词条，build 一次性编译成只读结构，之后只做查找：
+ * - 所有词串依次存放在一块连续内存 pool_ 中
+ * - 布隆过滤器（每个词 2 个比特位）先排除绝大多数不在表中的词，只需一次哈希、两次位读取
+ * - 通过布隆过滤的词在开放寻址表中线性探测，先比较哈希值再比较字节
+ * 一个词同时带有停用词 / 敏感词标记，isValidWord 只需查找一次
+ *
+ * build 之后只读，多线程并发查找无需加锁。
+ */
+class WordFilter {
+public:
+    //词条标记，可按位组合
+    static constexpr uint8_t STOP = 0x1;
+    static constexpr uint8_t SENSITIVE = 0x2;
+
+    /**
+     * 加入一个词条（build 之前调用）；同一个词多次加入时标记取并集
+     * @param word 词，空串忽略
+     * @param flag STOP / SENSITIVE
+     */
+    void add(std::string_view word, uint8_t flag);
+
+    //编译查找结构，之后的 add 需要再次 build 才生效
+    void build();
+
+    /**
+     * 查找词的标记
+     * @return 不在表中时为 0
+     */
+    uint8_t flags(std::string_view word) const {
+        if (word.size() < min_length_ || word.size() > max_length_) {
+            return 0;
+        }
+        uint64_t h = hash(word);
+        if (!mayContain(h)) {
+            return 0;
+        }
+        for (size_t i = h & slot_mask_;; i = (i + 1) & slot_mask_) {
+            const Slot& slot = slots_[i];
+            if (slot.length == 0) {
+                return 0;
+            }
+            if (slot.hash == h && slot.length == word.size() &&
+                std::string_view(pool_.data() + slot.offset, slot.length) == word) {
+                return slot.flags;
+            }
+        }
+    }
+
+    bool contains(std::string_view word, uint8_t flag) const { return (flags(word) & flag) != 0; }
+
+    //带有 flag 标记的词条数
+    size_t count(uint8_t flag) const;
+
+    //不同词条总数
+    size_t size() const { return entries_; }
+
+    //查找结构占用的内存（字节）
+    size_t memoryUsage() const;
+
+private:
+    struct Slot {
+        uint64_t hash=0;
+        uint32_t offset=0;//词在 pool_ 中的起始位置
+        uint16_t length=0;//词长（字节），0 表示空槽
+        uint8_t flags=0;
+    };
+
+    static uint64_t hash(std::string_view word) { return std::hash<std::string_view>{}(word); }
+
+    bool mayContain(uint64_t h) const {
+        uint64_t a = h >> bloom_shift_;
+        uint64_t b = (h >> 20) & bloom_mask_;
+        return ((bloom_[a >> 6] >> (a & 63)) & (bloom_[b >> 6] >> (b & 63)) & 1) != 0;
+    }
+
+    std::vector<std::pair<std::string, uint8_t>> pending_;//add 暂存，build 时编译
+
+    std::string pool_;//所有词串首尾相接
+    std::vector<Slot> slots_;//开放寻址表，容量为 2 的幂，负载因子不超过 1/2
+    size_t slot_mask_=0;
+    std::vector<uint64_t> bloom_;//布隆过滤器位图
+    uint64_t bloom_mask_=0;//位数 - 1（位数为 2 的幂）
+    unsigned bloom_shift_=63;//取哈希高位作为第一个位下标
+    size_t min_length_=1;
+    size_t max_length_=0;//build 之前为 0，所有查找直接返回 0
+    size_t entries_=0;
+};
+
+#endif // WORDFILTER_H
@@ -0,0 +1,314 @@
+#include "CountMinCounter.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace {
+//为每行生成固定的哈希乘数（splitmix64），结果可复现
+uint64_t splitmix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+}
+
+CountMinCounter::CountMinCounter(double epsilon, double delta, size_t heavy_hitters,
+                                 unsigned int window_seconds, size_t panes)
+{
+    // 参数越界时退回默认配置
+    if (!(epsilon > 0.0 && epsilon < 1.0)) {
+        epsilon = CounterOptions().epsilon;
+    }
+    if (!(delta > 0.0 && delta < 1.0)) {
+        delta = CounterOptions().delta;
+    }
+
+    // 列数 e / epsilon 向上取到 2 的幂（至少 64），便于乘法哈希直接取高位
+    size_t want = static_cast<size_t>(std::ceil(std::exp(1.0) / epsilon));
+    unsigned int bits = 6;
+    while ((size_t(1) << bits) < want && bits < 31) {
+        ++bits;
+    }
+    width_ = size_t(1) << bits;
+    shift_ = 64 - bits;
+    depth_ = std::max<size_t>(1, static_cast<size_t>(std::ceil(std::log(1.0 / delta))));
+
+    uint64_t state = 0x5eed;
+    seeds_.resize(depth_);
+    for (auto& seed : seeds_) {
+        seed = splitmix64(state) | 1;
+    }
+    table_.assign(width_ * depth_, 0);
+    zero_cells_ = width_;
+
+    capacity_ = std::max<size_t>(1, heavy_hitters);
+    heap_.reserve(capacity_);
+    pos_.reserve(capacity_);
+
+    // 窗口内的 window_seconds + 1 秒分成 panes 段；窗口跨越的段数最多再多一个（两端不对齐）
+    if (window_seconds > 0 && panes > 0) {
+        size_t span = static_cast<size_t>(window_seconds) + 1;
+        pane_seconds_ = static_cast<unsigned int>((span + panes - 1) / panes);
+        panes_.resize((span + pane_seconds_ - 1) / pane_seconds_ + 1);
+    }
+}
+
+void CountMinCounter::add(WordId id, int delta)
+{
+    addTo(nullptr, id, delta);
+}
+
+void CountMinCounter::addAt(unsigned int ts, WordId id, int delta)
+{
+    if (panes_.empty()) {
+        addTo(nullptr, id, delta);
+        return;
+    }
+    Pane& pane = paneFor(ts);
+    if (delta < 0 && static_cast<size_t>(-delta) > pane.total) {
+        pane.total = 0;
+    } else {
+        pane.total += delta;
+    }
+    addTo(pane.table.data(), id, delta);
+}
+
+void CountMinCounter::expireBefore(unsigned int expire_time)
+{
+    bool expired = false;
+    for (auto& pane : panes_) {
+        if (pane.used && static_cast<uint64_t>(pane.id + 1) * pane_seconds_ <= expire_time) {
+            expirePane(pane);
+            expired = true;
+        }
+    }
+    if (expired) {
+        refreshCandidates();
+    }
+}
+
+void CountMinCounter::addTo(int* pane, WordId id, int delta)
+{
+    if (delta == 0) {
+        return;
+    }
+
+    int estimate = INT_MAX;
+    for (size_t r = 0; r < depth_; ++r) {
+        size_t c = r * width_ + column(r, id);
+        int& cell = table_[c];
+        if (r == 0) {
+            zero_cells_ -= (cell == 0);
+            zero_cells_ += (cell + delta == 0);
+        }
+        cell += delta;
+        estimate = std::min(estimate, cell);
+        if (pane) {
+            pane[c] += delta;
+        }
+    }
+
+    if (delta < 0 && static_cast<size_t>(-delta) > total_) {
+        total_ = 0;
+    } else {
+        total_ += delta;
+    }
+    updateCandidate(id, std::max(estimate, 0));
+}
+
+int CountMinCounter::count(WordId id) const
+{
+    int estimate = INT_MAX;
+    for (size_t r = 0; r < depth_; ++r) {
+        estimate = std::min(estimate, table_[r * width_ + column(r, id)]);
+    }
+    return std::max(estimate, 0);
+}
+
+size_t CountMinCounter::unique() const
+{
+    // 线性计数：n ≈ width * ln(width / 空计数器数)
+    size_t zeros = std::max<size_t>(zero_cells_, 1);
+    return static_cast<size_t>(std::llround(
+        static_cast<double>(width_) * std::log(static_cast<double>(width_) / zeros)));
+}
+
+void CountMinCounter::topK(size_t k, std::vector<std::pair<WordId, int>> &out) const
+{
+    // 堆中的估计值在写入该词时记录，之后碰撞词的增减会让它过时：按当前计数矩阵重新估计
+    out.clear();
+    out.reserve(heap_.size());
+    for (const auto& item : heap_) {
+        int estimate = count(item.first);
+        if (estimate > 0) {
+            out.emplace_back(item.first, estimate);
+        }
+    }
+    size_t keep = std::min(k, out.size());
+    std::partial_sort(out.begin(), out.begin() + keep, out.end(),
+        [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+    out.resize(keep);
+}
+
+size_t CountMinCounter::memoryUsage() const
+{
+    size_t panes = panes_.capacity() * sizeof(Pane);
+    for (const auto& pane : panes_) {
+        panes += pane.table.capacity() * sizeof(int);
+    }
+    // 哈希表节点按 键值对 + next 指针估算
+    return panes + table_.capacity() * sizeof(int) +
+           seeds_.capacity() * sizeof(uint64_t) +
+           heap_.capacity() * sizeof(std::pair<WordId, int>) +
+           pos_.size() * (sizeof(std::pair<const WordId, uint32_t>) + sizeof(void*)) +
+           pos_.bucket_count() * sizeof(void*);
+}
+
+size_t CountMinCounter::errorBound() const
+{
+    return static_cast<size_t>(std::ceil(std::exp(1.0) / width_ * total_));
+}
+
+CountMinCounter::Pane &CountMinCounter::paneFor(unsigned int ts)
+{
+    unsigned int id = ts / pane_seconds_;
+    Pane& pane = panes_[id % panes_.size()];
+    if (pane.used && pane.id != id) {
+        // 窗口淘汰会先于复用清空旧段；若仍有数据则先减去，保证计数不泄漏
+        expirePane(pane);
+        refreshCandidates();
+    }
+    if (!pane.used) {
+        if (pane.table.empty()) {
+            pane.table.assign(width_ * depth_, 0);
+        }
+        pane.id = id;
+        pane.used = true;
+        pane.total = 0;
+    }
+    return pane;
+}
+
+void CountMinCounter::expirePane(Pane &pane)
+{
+    for (size_t c = 0; c < pane.table.size(); ++c) {
+        int v = pane.table[c];
+        if (v == 0) {
+            continue;
+        }
+        int& cell = table_[c];
+        if (c < width_) {
+            zero_cells_ -= (cell == 0);
+            zero_cells_ += (cell - v == 0);
+        }
+        cell -= v;
+        pane.table[c] = 0;
+    }
+    total_ = total_ > pane.total ? total_ - pane.total : 0;
+    pane.total = 0;
+    pane.used = false;
+}
+
+void CountMinCounter::refreshCandidates()
+{
+    size_t n = 0;
+    for (size_t i = 0; i < heap_.size(); ++i) {
+        int estimate = count(heap_[i].first);
+        if (estimate > 0) {
+            heap_[n++] = std::make_pair(heap_[i].first, estimate);
+        }
+    }
+    heap_.resize(n);
+    pos_.clear();
+    for (uint32_t i = 0; i < n; ++i) {
+        pos_[heap_[i].first] = i;
+    }
+    for (size_t i = n / 2; i > 0; --i) {
+        siftDown(static_cast<uint32_t>(i - 1));
+    }
+}
+
+void CountMinCounter::updateCandidate(WordId id, int estimate)
+{
+    auto it = pos_.find(id);
+    if (it != pos_.end()) {
+        uint32_t i = it->second;
+        if (estimate <= 0) {
+            removeAt(i);
+            return;
+        }
+        int old = heap_[i].second;
+        heap_[i].second = estimate;
+        if (estimate < old) {
+            siftUp(i);
+        } else {
+            siftDown(i);
+        }
+        return;
+    }
+
+    if (estimate <= 0) {
+        return;
+    }
+    if (heap_.size() < capacity_) {
+        heap_.emplace_back(id, estimate);
+        pos_[id] = static_cast<uint32_t>(heap_.size() - 1);
+        siftUp(static_cast<uint32_t>(heap_.size() - 1));
+    } else if (estimate > heap_[0].second) {
+        // 换出估计词频最低的候选
+        pos_.erase(heap_[0].first);
+        place(0, std::make_pair(id, estimate));
+        siftDown(0);
+    }
+}
+
+void CountMinCounter::siftUp(uint32_t i)
+{
+    std::pair<WordId, int> item = heap_[i];
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (heap_[parent].second <= item.second) {
+            break;
+        }
+        place(i, heap_[parent]);
+        i = parent;
+    }
+    place(i, item);
+}
+
+void CountMinCounter::siftDown(uint32_t i)
+{
+    std::pair<WordId, int> item = heap_[i];
+    uint32_t n = static_cast<uint32_t>(heap_.size());
+    while (true) {
+        uint32_t child = 2 * i + 1;
+        if (child >= n) {
+            break;
+        }
+        if (child + 1 < n && heap_[child + 1].second < heap_[child].second) {
+            ++child;
+        }
+        if (item.second <= heap_[child].second) {
+            break;
+        }
+        place(i, heap_[child]);
+        i = child;
+    }
+    place(i, item);
+}
+
+void CountMinCounter::removeAt(uint32_t i)
+{
+    pos_.erase(heap_[i].first);
+    std::pair<WordId, int> last = heap_.back();
+    heap_.pop_back();
+    if (i < heap_.size()) {
+        place(i, last);
+        siftUp(i);
+        siftDown(pos_[last.first]);
+    }
+}
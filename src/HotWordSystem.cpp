@@ -1,15 +1,18 @@
 #include "HotWordSystem.h"
 #include "spdlog/spdlog.h"
 
-HotWordSystem::HotWordSystem(const std::string &input_file, const std::string &output_file, size_t buffer_capacity, size_t low_watermark, uint32_t window_size, size_t num_stat_threads)
+HotWordSystem::HotWordSystem(const std::string &input_file, const std::string &output_file, size_t buffer_capacity, size_t low_watermark, uint32_t window_size, size_t num_stat_threads, size_t num_tokenizer_threads, const CounterOptions &counter_options, bool mask_sensitive)
  :  input_file_(input_file),
     output_file_(output_file),
     buffer_capacity_(buffer_capacity),
     low_watermark_(low_watermark),
     window_size_(window_size),
     num_stat_threads_(num_stat_threads),
-    buffer_(buffer_capacity_, low_watermark_),
-    sliding_window_(window_size_),
+    num_tokenizer_threads_(num_tokenizer_threads),
+    mask_sensitive_(mask_sensitive),
+    buffer_(buffer_capacity_, low_watermark_,
+            num_stat_threads_ > 1 ? BufferMode::MPMC : BufferMode::SPSC), // 单个输入线程：单消费者用 SPSC，多个统计线程用 MPMC
+    sliding_window_(window_size_, 60, num_stat_threads_ > 1 ? num_stat_threads_ * 4 : 1, counter_options), // 多统计线程时分片写入，减少锁竞争
     query_handler_(output_file_),
     running_(true) // 初始为运行状态
 {
@@ -23,7 +26,15 @@ HotWordSystem::HotWordSystem(const std::string &input_file, const std::string &o
     spdlog::info("  Buffer capacity:  {}", buffer_capacity_);
     spdlog::info("  Low watermark:    {}", low_watermark_);
     spdlog::info("  Window size:      {}s ({}min)", window_size_, window_size_ / 60);
+    // 分词线程数为 0 时按 CPU 核数自动选择：扣除输入线程和统计线程，至少 1 个
+    if (num_tokenizer_threads_ == 0) {
+        size_t cores = std::thread::hardware_concurrency();
+        num_tokenizer_threads_ = cores > num_stat_threads_ + 1 ? cores - num_stat_threads_ - 1 : 1;
+    }
+
     spdlog::info("  Stat threads:     {}", num_stat_threads_);
+    spdlog::info("  Tokenizer threads:{}", num_tokenizer_threads_);
+    spdlog::info("  Mask sensitive:   {}", mask_sensitive_ ? "on" : "off");
 
     // 1. 创建输入线程对象
     spdlog::info("Creating InputThread...");
@@ -33,7 +44,9 @@ HotWordSystem::HotWordSystem(const std::string &input_file, const std::string &o
         query_queue_,
         query_mutex_,
         running_,
-        100  // batch_size
+        100,  // batch_size
+        num_tokenizer_threads_,
+        mask_sensitive_
     );
     spdlog::info("InputThread created successfully");
     
@@ -123,6 +136,9 @@ void HotWordSystem::join()
     }
     spdlog::debug("StatisticsThread [{}] terminated",stat_thread_handles_.size() );
 
+    // 所有查询都已输出：把缓冲中的结果写入文件并落盘
+    query_handler_.flush(true);
+
     spdlog::info(">>> All Threads Terminated Successfully <<<");
     spdlog::info("=================================================");
 }
@@ -1,15 +1,19 @@
 #include "InputHandler.h"
 #include <iostream>
-#include <sstream>
 #include <string>
-#include <regex>
 #include <iostream>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "spdlog/spdlog.h"
 using namespace std;
 
-InputHandler::InputHandler(const std::string &input_file):input_file_(input_file)
+InputHandler::InputHandler(const std::string &input_file, bool use_mmap):input_file_(input_file),use_mmap_(use_mmap)
 {
-    spdlog::info("InputHandler initialized: input_file={}", input_file_);
+    spdlog::info("InputHandler initialized: input_file={}, mmap={}", input_file_, use_mmap_);
 }
 
 InputHandler::~InputHandler()
@@ -19,6 +23,11 @@ InputHandler::~InputHandler()
 
 bool InputHandler::open()
 {   
+    if(use_mmap_ && openMapped()){
+        spdlog::info("Input file mapped successfully: {} ({} bytes)", input_file_, size_);
+        return true;
+    }
+
     file_stream_.open(input_file_);
     
     if(!file_stream_.is_open()){
@@ -29,8 +38,69 @@ bool InputHandler::open()
     return true;
 }
 
+bool InputHandler::openMapped()
+{
+    int fd=::open(input_file_.c_str(), O_RDONLY);
+    if(fd<0){
+        return false;
+    }
+
+    struct stat st;
+    if(fstat(fd,&st)!=0 || !S_ISREG(st.st_mode)){
+        ::close(fd);
+        spdlog::info("Input is not a regular file, falling back to stream reading: {}", input_file_);
+        return false;
+    }
+
+    size_t size=static_cast<size_t>(st.st_size);
+    const char* data=nullptr;
+    if(size>0){
+        void* addr=mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(addr==MAP_FAILED){
+            ::close(fd);
+            spdlog::warn("mmap failed for {}, falling back to stream reading", input_file_);
+            return false;
+        }
+        madvise(addr, size, MADV_SEQUENTIAL);//顺序读取，提示内核预读
+        data=static_cast<const char*>(addr);
+    }
+
+    fd_=fd;
+    data_=data;
+    size_=size;
+    cursor_=0;
+    mapped_=true;
+    return true;
+}
+
 void InputHandler::close()
 {   
+    if(mapped_ || file_stream_.is_open()){
+        spdlog::info("Input parse stats: lines={}, text={}, query={}, blank={}, bad_timestamp={}, bad_query={}, out_of_order={}",
+                     stats_.lines, stats_.text_lines, stats_.query_lines, stats_.blank_lines,
+                     stats_.malformed_timestamp, stats_.malformed_query, stats_.out_of_order);
+
+        auto perf_logger = spdlog::get("perf");
+        if (perf_logger) {
+            perf_logger->info("{},input_malformed_timestamp,{}", std::time(nullptr), stats_.malformed_timestamp);
+            perf_logger->info("{},input_malformed_query,{}", std::time(nullptr), stats_.malformed_query);
+            perf_logger->info("{},input_out_of_order,{}", std::time(nullptr), stats_.out_of_order);
+        }
+    }
+
+    if(mapped_){
+        if(data_!=nullptr){
+            munmap(const_cast<char*>(data_), size_);
+        }
+        ::close(fd_);
+        fd_=-1;
+        data_=nullptr;
+        size_=0;
+        cursor_=0;
+        mapped_=false;
+        spdlog::info("Input file unmapped");
+    }
+
     if(file_stream_.is_open()){
         file_stream_.close();
         spdlog::info("Input file closed");
@@ -39,81 +109,179 @@ void InputHandler::close()
 
 bool InputHandler::readLine(unsigned int &timestamp, std::string &text, bool &is_query, int &k)
 {
-    std::string line;
-    if(!std::getline(file_stream_,line)){
+    std::string_view view;
+    if(!readLine(timestamp,view,is_query,k)){
         return false;
     }
+    text.assign(view.data(),view.size());
+    return true;
+}
 
-    timestamp=parseTimestamp(line);
+bool InputHandler::nextLine(std::string_view &line)
+{
+    if(!mapped_){
+        if(!std::getline(file_stream_,line_)){
+            return false;
+        }
+        line=line_;
+        return true;
+    }
 
-    // 【异常处理】时间戳乱序/迟到检测
-    if (timestamp > ts) {
-        ts = timestamp;
-    } else {
-        spdlog::debug("Out-of-order timestamp detected: current={}, previous={}", 
-                     timestamp, ts);
-        timestamp = ts;
+    if(cursor_>=size_){
+        return false;
     }
 
-    text=extractText(line);
-    k = parseQueryCommand(line);
-    is_query=(k==-1)?false:true;
-    
+    //memchr 由 libc 以向量指令实现，一次比较多个字节
+    const char* begin=data_+cursor_;
+    size_t remaining=size_-cursor_;
+    const char* nl=static_cast<const char*>(memchr(begin,'\n',remaining));
+
+    size_t len=nl?static_cast<size_t>(nl-begin):remaining;
+    line=std::string_view(begin,len);
+    cursor_+=nl?len+1:len;
     return true;
-    
 }
 
-bool InputHandler::eof() const
+namespace {
+
+inline bool isBlank(char c)
 {
-    return file_stream_.eof();
+    return c==' ' || c=='\t' || c=='\r' || c=='\n';
 }
 
-unsigned int InputHandler::parseTimestamp(const std::string &line)
+inline bool isDigit(char c)
 {
-    regex timePattern(R"(\[(\d+):(\d+):(\d+)\])");
-    smatch match;
-    
-    if (regex_search(line, match, timePattern)) {
-        int h = stoi(match[1]);
-        int m = stoi(match[2]);
-        int s = stoi(match[3]);
-        return h * 3600 + m * 60 + s;
+    return c>='0' && c<='9';
+}
+
+/**
+ * 从 p 开始读取 1~max_digits 位十进制数，成功时 p 移到数字之后
+ */
+inline bool parseUInt(const char*& p, const char* end, int max_digits, unsigned int& value)
+{
+    const char* start=p;
+    value=0;
+    while(p<end && isDigit(*p)){
+        if(p-start>=max_digits){
+            return false;
+        }
+        value=value*10+static_cast<unsigned int>(*p-'0');
+        ++p;
     }
-    return 0;  
+    return p>start;
 }
 
-string InputHandler::extractText(const string &line)
+//若 [p,end) 以 lit 开头则跳过并返回 true
+inline bool consume(const char*& p, const char* end, std::string_view lit)
 {
-    size_t pos=line.find(']');
-    string text;
+    if(static_cast<size_t>(end-p)<lit.size() || std::string_view(p,lit.size())!=lit){
+        return false;
+    }
+    p+=lit.size();
+    return true;
+}
 
-    if(pos!=string::npos && pos+1<line.length()){
-        text=line.substr(pos+1);
+inline void skipBlank(const char*& p, const char* end)
+{
+    while(p<end && isBlank(*p)){
+        ++p;
     }
+}
+
+}
 
-    //找第一个和最后一个非空字符
-    size_t start=text.find_first_not_of(" \t\r\n");
-    size_t end=text.find_last_not_of(" \t\r\n");
+bool InputHandler::parseLine(std::string_view line, unsigned int &timestamp, std::string_view &text, bool &is_query, int &k)
+{
+    const char* p=line.data();
+    const char* end=p+line.size();
+
+    //去掉行尾空白（含 Windows 的 \r）
+    while(end>p && isBlank(end[-1])){
+        --end;
+    }
+    //UTF-8 BOM
+    if(end-p>=3 && static_cast<unsigned char>(p[0])==0xEF &&
+       static_cast<unsigned char>(p[1])==0xBB && static_cast<unsigned char>(p[2])==0xBF){
+        p+=3;
+    }
+    skipBlank(p,end);
+
+    if(p==end){
+        stats_.blank_lines++;
+        return false;
+    }
+
+    //查询行：[ACTION] QUERY K=数字
+    if(consume(p,end,"[ACTION]")){
+        unsigned int value=0;
+        skipBlank(p,end);
+        bool ok=consume(p,end,"QUERY");
+        skipBlank(p,end);
+        ok=ok && consume(p,end,"K=") && parseUInt(p,end,9,value) && p==end && value>0;
+        if(!ok){
+            stats_.malformed_query++;
+            spdlog::warn("Malformed query line skipped: '{}'", line.substr(0,100));
+            return false;
+        }
+        is_query=true;
+        k=static_cast<int>(value);
+        timestamp=ts;//查询没有自己的时间戳，取当前已读到的最大时间戳
+        text={};
+        stats_.query_lines++;
+        return true;
+    }
 
-    if(start!=string::npos){
-        return text.substr(start,end-start+1);
+    //文本行：[H:MM:SS] 文本
+    unsigned int h=0,m=0,sec=0;
+    bool ok=consume(p,end,"[") &&
+            parseUInt(p,end,5,h) && consume(p,end,":") &&
+            parseUInt(p,end,2,m) && consume(p,end,":") &&
+            parseUInt(p,end,2,sec) && consume(p,end,"]") &&
+            m<60 && sec<60;
+    if(!ok){
+        stats_.malformed_timestamp++;
+        spdlog::debug("Line without valid timestamp skipped: '{}'", line.substr(0,100));
+        return false;
     }
 
-    return "";
+    skipBlank(p,end);
+    is_query=false;
+    k=-1;
+    timestamp=h*3600+m*60+sec;
+    text=std::string_view(p,static_cast<size_t>(end-p));
+    stats_.text_lines++;
+    return true;
 }
 
-int InputHandler::parseQueryCommand(const std::string &line)
+bool InputHandler::readLine(unsigned int &timestamp, std::string_view &text, bool &is_query, int &k)
 {
-    size_t pos=line.find("[ACTION] QUERY");
+    std::string_view line;
+    if(!nextLine(line)){
+        return false;
+    }
+    stats_.lines++;
 
-    if(pos==std::string::npos){
-        return -1;
+    if(!parseLine(line,timestamp,text,is_query,k)){
+        return false;
     }
-    else{
-        size_t posk=line.find("K=");
-        if(posk!=std::string::npos){
-            return stoi(line.substr(posk+2));
-        }
-        else return -1;
+
+    // 【异常处理】时间戳乱序/迟到检测
+    if (timestamp > ts) {
+        ts = timestamp;
+    } else if (!is_query && timestamp < ts) {
+        spdlog::debug("Out-of-order timestamp detected: current={}, previous={}", 
+                     timestamp, ts);
+        stats_.out_of_order++;
+        timestamp = ts;
+    }
+    
+    return true;
+}
+
+bool InputHandler::eof() const
+{
+    if(mapped_){
+        return cursor_>=size_;
     }
+    return file_stream_.eof();
 }
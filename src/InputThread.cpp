@@ -4,19 +4,21 @@
 #include <chrono>
 
 
-InputThread::InputThread(const std::string &input_file, Buffer<TimeSlot> &buffer, std::queue<QueryCommand> &query_queue, std::mutex &query_mutex, std::atomic<bool> &running, size_t batch_size):
+InputThread::InputThread(const std::string &input_file, Buffer<TimeSlot> &buffer, std::queue<QueryCommand> &query_queue, std::mutex &query_mutex, std::atomic<bool> &running, size_t batch_size, size_t num_tokenizers, bool mask_sensitive):
     buffer_(buffer),
     query_queue_(query_queue),
     query_mutex_(query_mutex),
     running_(running),
-    batch_size_(batch_size)
+    batch_size_(batch_size > 0 ? batch_size : 1),
+    num_tokenizers_(num_tokenizers)
 {
     spdlog::info("=== InputThread Initializing ===");
     spdlog::info("Input file: {}", input_file);
     spdlog::info("Batch size: {}", batch_size_);
+    spdlog::info("Tokenizer threads: {}", num_tokenizers_);
 
     input_handler_=std::make_unique<InputHandler>(input_file);
-    text_processor_ = std::make_unique<TextProcessor>("../dict/", true);//如果是为了测试可以临时改为../../dict,正式运行为../dict
+    text_processor_ = std::make_unique<TextProcessor>("../dict/", true, mask_sensitive);//如果是为了测试可以临时改为../../dict,正式运行为../dict
 
     spdlog::info(">>> InputThread Initialized Successfully <<<");
 }
@@ -36,9 +38,11 @@ void InputThread::run()
         return;
     }
 
-    // 批次缓存,提高吞吐量
-    std::vector<TimeSlot> batch;
-    batch.reserve(batch_size_);
+    // 分词工作池（共享同一个只读的 Jieba），按块提交、按提交顺序取回
+    TokenizerPool pool(*text_processor_, num_tokenizers_);
+    std::vector<InputLine> chunk_lines;
+    chunk_lines.reserve(batch_size_);
+    TokenizerPool::Chunk chunk;
 
     // 统计信息，便于调试（日志）
     size_t total_lines = 0;
@@ -49,89 +53,49 @@ void InputThread::run()
     // 性能统计
     size_t processed_since_last_report = 0;
     double total_preprocess_time_ms = 0.0;
+    bool success = true;
 
-    // 数据的变量
-    unsigned int timestamp;
-    std::string text;
-    bool is_query;
-    int k;
-
-    while (running_.load() && !input_handler_->eof()) {
+    while (success && running_.load() && !input_handler_->eof()) {
         // 读取一行
-        if (!input_handler_->readLine(timestamp, text, is_query, k)) {
+        InputLine line;
+        if (!input_handler_->readLine(line.timestamp, line.view, line.is_query, line.k)) {
             continue;
         }
 
+        // mmap 模式下文本直接引用映射区（在所有块取回后才 close）；回退模式下需要拷贝
+        if (!input_handler_->mapped()) {
+            line.owned.assign(line.view.data(), line.view.size());
+        }
+
         total_lines++;
         processed_since_last_report++;
-
-        if (is_query) {
+        if (line.is_query) {
             query_lines++;
+        } else {
+            text_lines++;
+        }
+        chunk_lines.push_back(std::move(line));
 
-            // 在锁中调用而后释放
-            {
-                std::lock_guard<std::mutex> lock(query_mutex_);
-                query_queue_.push(QueryCommand(timestamp, k));
-            }
-
-            spdlog::info("Query command received: timestamp={}, K={}", timestamp, k);
-
-            auto op_logger = spdlog::get("operation");
-            if (op_logger) {
-                op_logger->info("Query enqueued: timestamp={}, K={}", timestamp, k);
-            }
-
+        if (chunk_lines.size() < batch_size_) {
             continue;
         }
 
-        text_lines++;
+        pool.submit(std::move(chunk_lines));
+        chunk_lines.clear();
+        chunk_lines.reserve(batch_size_);
 
-        // 文本预处理时间计时
-        auto preprocess_start = std::chrono::high_resolution_clock::now();
+        // 在途块已满：取回最早的块并写入 Buffer（Buffer 满时在此阻塞，形成背压）
+        while (success && pool.full() && pool.next(chunk)) {
+            total_preprocess_time_ms += chunk.process_ms;
 
-        TimeSlot slot(timestamp);
-        slot.words = text_processor_->processWithPOS(text);
-
-        auto preprocess_end = std::chrono::high_resolution_clock::now();
-        auto preprocess_ms = std::chrono::duration<double, std::milli>(
-            preprocess_end - preprocess_start).count();
-        total_preprocess_time_ms += preprocess_ms;
-
-        total_words += slot.words.size();
-
-        if (!slot.words.empty()) {
-            batch.push_back(std::move(slot));
-            spdlog::trace("Text processed: timestamp={}, words={}, time={:.2f}ms", 
-                         timestamp, slot.words.size(), preprocess_ms);
-        }
-
-        if (batch.size() >= batch_size_) {
-            // 批次提交时间计时
             auto batch_start = std::chrono::high_resolution_clock::now();
-
-            bool success = true;
-            int pushed_count = 0;
-            for (auto& item : batch) {
-                if (!buffer_.push(std::move(item))) {
-                    spdlog::warn("Buffer closed, stopping input. Pushed {}/{} items", 
-                               pushed_count, batch.size());
-                    success = false;
-                    break;
-                }
-                pushed_count++;
-            }
-            
+            success = emitChunk(chunk, total_words);
             auto batch_end = std::chrono::high_resolution_clock::now();
             auto batch_ms = std::chrono::duration<double, std::milli>(
                 batch_end - batch_start).count();
-            
-            spdlog::debug("Batch submitted: size={}, time={:.2f}ms", batch.size(), batch_ms);
-
-            batch.clear();
 
-            if (!success) {
-                break;
-            }
+            spdlog::debug("Batch submitted: size={}, tokenize={:.2f}ms, push={:.2f}ms", 
+                         chunk.lines.size(), chunk.process_ms, batch_ms);
         }
 
         // 定期报告吞吐量（每5秒）
@@ -149,11 +113,13 @@ void InputThread::run()
                                 std::time(nullptr), throughput);
                 perf_logger->info("{},avg_preprocess_ms,{:.3f}", 
                                 std::time(nullptr), avg_preprocess_ms);
+                perf_logger->info("{},tokenizer_chunks_in_flight,{}", 
+                                std::time(nullptr), pool.pending());
             }
             
             spdlog::info("--- InputThread Performance ---");
             spdlog::info("Throughput: {:.2f} lines/sec", throughput);
-            spdlog::info("Avg preprocess: {:.3f}ms/line", avg_preprocess_ms);
+            spdlog::info("Avg preprocess: {:.3f}ms/line (worker time)", avg_preprocess_ms);
             spdlog::info("Processed: {} lines, {} words", 
                         processed_since_last_report, total_words);
             
@@ -164,14 +130,17 @@ void InputThread::run()
         }
     } 
 
-    // 清理+日志
-    spdlog::info("InputThread: Submitting remaining {} items in batch", batch.size());
-   
-    for (auto& item : batch) {
-        if (!buffer_.push(std::move(item))) {
+    // 清理+日志：提交最后不满一块的行，并按顺序取回全部在途块
+    if (success && !chunk_lines.empty()) {
+        pool.submit(std::move(chunk_lines));
+    }
+    spdlog::info("InputThread: Submitting remaining {} chunks", pool.pending());
+
+    while (pool.next(chunk)) {
+        if (success && !emitChunk(chunk, total_words)) {
             spdlog::warn("Buffer closed while submitting remaining items");
-            break;
-        }   
+            success = false;
+        }
     }
     
     buffer_.markInputFinished();
@@ -209,4 +178,59 @@ void InputThread::run()
     }
 
     spdlog::info("<<< InputThread Terminated <<<");
-}
\ No newline at end of file
+}
+
+bool InputThread::emitChunk(TokenizerPool::Chunk &chunk, size_t &total_words)
+{
+    // 连续的文本行攒成一批，一次 pushBatch 写入；遇到查询或块结束时提交
+    thread_local std::vector<TimeSlot> slots;
+    slots.clear();
+
+    auto flush = [&]() {
+        size_t pushed = buffer_.pushBatch(slots);
+        pushed_slots_ += pushed;
+        bool ok = pushed == slots.size();
+        if (!ok) {
+            spdlog::warn("Buffer closed, stopping input. Pushed {}/{} items", pushed, slots.size());
+        }
+        slots.clear();
+        return ok;
+    };
+
+    for (size_t i = 0; i < chunk.lines.size(); ++i) {
+        const InputLine& line = chunk.lines[i];
+
+        if (line.is_query) {
+            if (!flush()) {
+                return false;
+            }
+
+            // 查询在其之前的文本全部写入 Buffer 后才入队，保持与输入文件一致的顺序
+            {
+                std::lock_guard<std::mutex> lock(query_mutex_);
+                query_queue_.push(QueryCommand(line.timestamp, line.k, pushed_slots_));
+            }
+
+            spdlog::info("Query command received: timestamp={}, K={}", line.timestamp, line.k);
+
+            auto op_logger = spdlog::get("operation");
+            if (op_logger) {
+                op_logger->info("Query enqueued: timestamp={}, K={}", line.timestamp, line.k);
+            }
+            continue;
+        }
+
+        if (chunk.words[i].empty()) {
+            continue;
+        }
+
+        TimeSlot slot(line.timestamp);
+        slot.words = std::move(chunk.words[i]);
+        total_words += slot.words.size();
+
+        spdlog::trace("Text processed: timestamp={}, words={}", line.timestamp, slot.words.size());
+
+        slots.push_back(std::move(slot));
+    }
+    return flush();
+}
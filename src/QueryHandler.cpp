@@ -1,11 +1,22 @@
 #include "QueryHandler.h"
+#include "WordDict.h"
 #include <iostream>
 #include "spdlog/spdlog.h"
-#include <chrono>
+#include <charconv>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
 
-QueryHandler::QueryHandler(const std::string &output_file):output_file_(output_file)
+QueryHandler::QueryHandler(const std::string &output_file, size_t flush_bytes, unsigned int flush_interval_ms)
+    :output_file_(output_file),
+     flush_bytes_(flush_bytes),
+     flush_interval_(flush_interval_ms),
+     last_flush_(std::chrono::steady_clock::now())
 {
-    spdlog::info("QueryHandler initialized: output_file={}", output_file_);
+    buffer_.reserve(flush_bytes_ + 4096);
+    spdlog::info("QueryHandler initialized: output_file={}, flush_bytes={}, flush_interval={}ms",
+                 output_file_, flush_bytes_, flush_interval_ms);
 }
 
 QueryHandler::~QueryHandler()
@@ -15,65 +26,134 @@ QueryHandler::~QueryHandler()
 
 bool QueryHandler::open()
 {
-    file_stream_.open(output_file_,std::ios::out | std::ios::trunc);
+    fd_ = ::open(output_file_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
 
-    if(!file_stream_.is_open()){
-        spdlog::error("Failed to open output file: {}", output_file_);
+    if(fd_ < 0){
+        spdlog::error("Failed to open output file: {} ({})", output_file_, std::strerror(errno));
         return false;
     }
+    last_flush_ = std::chrono::steady_clock::now();
     spdlog::info("Output file opened successfully: {}", output_file_);
     return true;
 }
 
 void QueryHandler::close()
 {
-    if(file_stream_.is_open()){
-        file_stream_.close();
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    if(fd_ >= 0){
+        flushLocked(false);
+        ::close(fd_);
+        fd_ = -1;
         spdlog::info("Output file closed");
     }
 }
 
-void QueryHandler::outputTopK(unsigned int timestamp, const std::vector<std::pair<std::string, int>> &topk)
+void QueryHandler::outputTopK(unsigned int timestamp, const std::vector<std::pair<WordId, int>> &topk)
 {
     auto start_time = std::chrono::high_resolution_clock::now();
-    
+
     std::lock_guard<std::mutex> lock(output_mutex_);
 
-    if(!file_stream_.is_open())open();
-    
-    std::string time_str=formatTimestamp(timestamp);
+    if(fd_ < 0)open();
 
-    file_stream_<<time_str<<" Top-"<<topk.size()<<":"<<std::endl;
+    appendTimestamp(timestamp);
+    buffer_ += " Top-";
+    appendNumber(static_cast<long long>(topk.size()));
+    buffer_ += ":\n";
 
+    const WordDict& dict=WordDict::instance();
     for(size_t i=0;i<topk.size();i++){
-        file_stream_<<(i+1)<<". "<<topk[i].first<<" (出现"<<topk[i].second<<"次)"<<std::endl;
+        appendNumber(static_cast<long long>(i+1));
+        buffer_ += ". ";
+        buffer_ += dict.word(topk[i].first);
+        buffer_ += " (出现";
+        appendNumber(topk[i].second);
+        buffer_ += "次)\n";
     }
 
-    file_stream_<<std::endl;
-    file_stream_.flush();//刷新磁盘，强制写入磁盘
+    buffer_ += '\n';
+
+    //达到大小或时间阈值才写入文件
+    if (buffer_.size() >= flush_bytes_ ||
+        std::chrono::steady_clock::now() - last_flush_ >= flush_interval_) {
+        flushLocked(false);
+    }
 
     //输出延迟
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration_ms = std::chrono::duration<double, std::milli>(
         end_time - start_time).count();
-    
+
     auto perf_logger = spdlog::get("perf");
     if (perf_logger) {
         perf_logger->info("{},output_write_ms,{:.3f}", std::time(nullptr), duration_ms);
     }
-    
+
     spdlog::debug("Output written in {:.3f}ms", duration_ms);
 }
 
-std::string QueryHandler::formatTimestamp(unsigned int seconds)
+bool QueryHandler::flush(bool sync)
+{
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    return flushLocked(sync);
+}
+
+bool QueryHandler::flushLocked(bool sync)
+{
+    last_flush_ = std::chrono::steady_clock::now();
+    if (fd_ < 0) {
+        //文件未能打开：丢弃结果，避免缓冲区无限增长
+        bool ok = buffer_.empty();
+        buffer_.clear();
+        return ok;
+    }
+
+    const char* data = buffer_.data();
+    size_t remaining = buffer_.size();
+    bool ok = true;
+    while (remaining > 0) {
+        ssize_t written = ::write(fd_, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            spdlog::error("Failed to write output file: {} ({})", output_file_, std::strerror(errno));
+            ok = false;
+            break;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    buffer_.clear();
+
+    if (ok && sync && ::fdatasync(fd_) != 0) {
+        spdlog::error("Failed to sync output file: {} ({})", output_file_, std::strerror(errno));
+        ok = false;
+    }
+    return ok;
+}
+
+void QueryHandler::appendTimestamp(unsigned int seconds)
 {
     unsigned int h=seconds/3600;
     unsigned int m=(seconds%3600)/60;
     unsigned int s=seconds%60;
 
-    std::ostringstream oss;
-
-    oss<<std::setfill('0')<<'['<<std::setw(2)<<h<<":"<<std::setw(2)<<m<<":"<<std::setw(2)<<s<<']';
+    buffer_ += '[';
+    appendNumber(h, 2);
+    buffer_ += ':';
+    appendNumber(m, 2);
+    buffer_ += ':';
+    appendNumber(s, 2);
+    buffer_ += ']';
+}
 
-    return oss.str();
+void QueryHandler::appendNumber(long long value, int width)
+{
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    for (int pad = width - static_cast<int>(end - digits); pad > 0; --pad) {
+        buffer_ += '0';
+    }
+    buffer_.append(digits, end);
 }
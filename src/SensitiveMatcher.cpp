@@ -0,0 +1,163 @@
+#include "SensitiveMatcher.h"
+#include <algorithm>
+#include <cstdint>
+
+void SensitiveMatcher::add(std::string_view word)
+{
+    if (word.empty()) {
+        return;
+    }
+    pending_.emplace_back(word);
+}
+
+void SensitiveMatcher::build()
+{
+    // 模式串排序去重；pending_ 保留，再次 build 时与新加入的词一起重新编译
+    std::sort(pending_.begin(), pending_.end());
+    pending_.erase(std::unique(pending_.begin(), pending_.end()), pending_.end());
+    const std::vector<std::string>& words = pending_;
+
+    // 1. 按字典序插入：与上一个词的公共前缀已在树中，只为剩余字节新建节点
+    //    节点按先序创建，同一父节点的子节点按字节递增创建
+    std::vector<uint32_t> parent(1, 0);
+    std::vector<uint8_t> key(1, 0);
+    std::vector<uint32_t> depth(1, 0);
+    std::vector<uint32_t> terminal(1, 0);//节点对应的模式串长度，0 表示不是模式串结尾
+    std::vector<uint32_t> path(1, 0);//上一个词经过的节点，path[d] 为深度 d 的节点
+    std::string_view prev;
+    for (const std::string& w : words) {
+        size_t lcp = 0;
+        while (lcp < prev.size() && lcp < w.size() && prev[lcp] == w[lcp]) {
+            ++lcp;
+        }
+        path.resize(w.size() + 1);
+        for (size_t d = lcp; d < w.size(); ++d) {
+            uint32_t node = static_cast<uint32_t>(parent.size());
+            parent.push_back(path[d]);
+            key.push_back(static_cast<uint8_t>(w[d]));
+            depth.push_back(static_cast<uint32_t>(d + 1));
+            terminal.push_back(0);
+            path[d + 1] = node;
+        }
+        terminal[path[w.size()]] = static_cast<uint32_t>(w.size());
+        prev = w;
+    }
+    size_t n = parent.size();
+
+    // 2. 子节点按父节点连续存放（CSR），创建顺序即字节顺序
+    std::vector<uint32_t> child_begin(n + 1, 0);
+    for (size_t v = 1; v < n; ++v) {
+        ++child_begin[parent[v] + 1];
+    }
+    for (size_t s = 0; s < n; ++s) {
+        child_begin[s + 1] += child_begin[s];
+    }
+    std::vector<uint8_t> child_keys(n - 1);
+    std::vector<uint32_t> child_nodes(n - 1);
+    std::vector<uint32_t> filled(child_begin.begin(), child_begin.end() - 1);
+    for (size_t v = 1; v < n; ++v) {
+        uint32_t pos = filled[parent[v]]++;
+        child_keys[pos] = key[v];
+        child_nodes[pos] = static_cast<uint32_t>(v);
+    }
+
+    child_begin_.swap(child_begin);
+    child_keys_.swap(child_keys);
+    child_nodes_.swap(child_nodes);
+    std::fill(std::begin(root_next_), std::end(root_next_), 0);
+    for (uint32_t i = child_begin_[0]; i < child_begin_[1]; ++i) {
+        root_next_[child_keys_[i]] = child_nodes_[i];
+    }
+
+    // 3. 按深度（BFS 顺序）计算失配链和输出长度，浅层状态总是先于深层完成
+    uint32_t max_depth = 0;
+    for (uint32_t d : depth) {
+        max_depth = std::max(max_depth, d);
+    }
+    std::vector<uint32_t> level_begin(max_depth + 2, 0);
+    for (uint32_t d : depth) {
+        ++level_begin[d + 1];
+    }
+    for (size_t d = 0; d <= max_depth; ++d) {
+        level_begin[d + 1] += level_begin[d];
+    }
+    std::vector<uint32_t> order(n);
+    for (size_t v = 0; v < n; ++v) {
+        order[level_begin[depth[v]]++] = static_cast<uint32_t>(v);
+    }
+
+    fail_.assign(n, 0);
+    out_len_.assign(n, 0);
+    for (size_t i = 1; i < n; ++i) {
+        uint32_t v = order[i];
+        uint32_t u = parent[v];
+        fail_[v] = u == 0 ? 0 : next(fail_[u], key[v]);
+        out_len_[v] = terminal[v] != 0 ? terminal[v] : out_len_[fail_[v]];
+    }
+
+    patterns_ = words.size();
+}
+
+const std::vector<std::pair<size_t, size_t>>& SensitiveMatcher::hits(std::string_view text) const
+{
+    thread_local std::vector<std::pair<size_t, size_t>> found;
+    found.clear();
+    scan(text, [](size_t begin, size_t end) {
+        found.emplace_back(begin, end);
+        return true;
+    });
+    return found;
+}
+
+void SensitiveMatcher::fill(char* data, const std::vector<std::pair<size_t, size_t>>& found, char mask)
+{
+    // 按结尾从后往前替换：[low, end) 已被结尾更靠后的命中覆盖，每个字节至多替换一次
+    size_t low = SIZE_MAX;
+    for (auto it = found.rbegin(); it != found.rend(); ++it) {
+        for (size_t i = it->first; i < std::min(it->second, low); ++i) {
+            data[i] = mask;
+        }
+        low = std::min(low, it->first);
+    }
+}
+
+bool SensitiveMatcher::mask(std::string& text, char mask) const
+{
+    const auto& found = hits(text);
+    if (found.empty()) {
+        return false;
+    }
+    fill(&text[0], found, mask);
+    return true;
+}
+
+bool SensitiveMatcher::mask(std::string_view text, std::string& out, char mask) const
+{
+    const auto& found = hits(text);
+    if (found.empty()) {
+        return false;
+    }
+    out.assign(text.data(), text.size());//有命中时才复制原文
+    fill(&out[0], found, mask);
+    return true;
+}
+
+bool SensitiveMatcher::containsAny(std::string_view text) const
+{
+    bool hit = false;
+    scan(text, [&](size_t, size_t) {
+        hit = true;
+        return false;
+    });
+    return hit;
+}
+
+size_t SensitiveMatcher::memoryUsage() const
+{
+    return sizeof(root_next_) +
+           child_begin_.capacity() * sizeof(uint32_t) +
+           child_keys_.capacity() * sizeof(uint8_t) +
+           child_nodes_.capacity() * sizeof(uint32_t) +
+           fail_.capacity() * sizeof(uint32_t) +
+           out_len_.capacity() * sizeof(uint32_t);
+}
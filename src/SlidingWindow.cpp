@@ -1,51 +1,79 @@
 #include "SlidingWindow.h"
+#include "WordDict.h"
 #include <algorithm>
 #include <cmath>
+#include <thread>
 #include "spdlog/spdlog.h"
 
-SlidingWindow::SlidingWindow(unsigned int window_size,unsigned int max_delay):window_size_(window_size),max_delay_(max_delay){
+SlidingWindow::SlidingWindow(unsigned int window_size,unsigned int max_delay,size_t num_shards,const CounterOptions &counter)
+    :window_size_(window_size),max_delay_(max_delay){
+    if (num_shards == 0) {
+        num_shards = 1;
+    }
+    shards_.reserve(num_shards);
+    for (size_t i = 0; i < num_shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>(window_size_, counter));
+    }
+
     spdlog::info("=== SlidingWindow Initialized ===");
     spdlog::info("Window size: {} seconds ({} minutes) Delay time: {} seconds ({} minutes) )", 
                  window_size_, window_size_ / 60,max_delay_,max_delay_/60);
+    spdlog::info("Window shards: {}", shards_.size());
+    if (counter.approximate) {
+        spdlog::info("Window counter: approximate (epsilon={}, delta={}, heavy hitters={}, panes={})",
+                     counter.epsilon, counter.delta, counter.heavy_hitters, counter.panes);
+    } else {
+        spdlog::info("Window counter: exact");
+    }
+
+    std::atomic_store(&snapshot_, std::shared_ptr<const Snapshot>(std::make_shared<Snapshot>()));
 }
 
 void SlidingWindow::addData(const TimeSlot &data)
 {
     auto start_time = std::chrono::high_resolution_clock::now();
-    std::lock_guard<std::mutex> lock(mutex_);
 
     unsigned int ts=data.timestamp;
 
-    if (ts > max_event_time) {
-        max_event_time=ts;
-        processDelayedData();
-    }
+    // 推进最大事件时间（多个统计线程并发写入，CAS 取最大值）
+    bool advanced=false;
+    unsigned int now=advanceTime(ts, advanced);
 
     // 丢弃过旧数据
-    if(max_event_time>ts+max_delay_){
-        spdlog::warn("SlidingWindow  Data too late: " + std::to_string(ts) + " vs current: " + std::to_string(max_event_time));
+    if(now>ts+max_delay_){
+        spdlog::warn("SlidingWindow  Data too late: " + std::to_string(ts) + " vs current: " + std::to_string(now));
+        slots_added_.fetch_add(1, std::memory_order_release);
         return;  
     }
 
-    if(ts < max_event_time){
-        delayed_buffer_[ts].insert(delayed_buffer_[ts].end(),data.words.begin(),data.words.end());
-        return;
+    if (advanced) {
+        evictAllShards(now);
     }
 
-    // 累加当前时间槽中的词频
-    for (const auto& word : data.words) {
-    ++word_count_[word];
-    }
-    // 建立时间索引（同一时间戳的词一起处理）
-    if (time_index_.find(ts) == time_index_.end()) {
-        time_index_[ts] = data.words;
+    if (shards_.size() == 1) {
+        addToShard(*shards_[0], data.words, ts, now);
     } else {
-        // 相同时间戳的词追加到已有列表
-        time_index_[ts].insert(time_index_[ts].end(),data.words.begin(),data.words.end());
+        // 按分片拆分词 ID（线程局部缓存，稳态无分配）
+        thread_local std::vector<std::vector<WordId>> parts;
+        size_t n = shards_.size();
+        if (parts.size() < n) {
+            parts.resize(n);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            parts[i].clear();
+        }
+        for (WordId id : data.words) {
+            parts[id % n].push_back(static_cast<WordId>(id / n));
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (!parts[i].empty()) {
+                addToShard(*shards_[i], parts[i], ts, now);
+            }
+        }
     }
-
-    // 淘汰过期数据（以 max_event_time 为基准）
-    evictExpiredData(max_event_time);
+    // 先递增版本再计数时间槽：等待时间槽到齐的查询一定会按包含本次写入的版本重建快照
+    commitVersion();
+    slots_added_.fetch_add(1, std::memory_order_release);
 
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
@@ -62,38 +90,171 @@ void SlidingWindow::addData(const TimeSlot &data)
     
 }
 
-//查询时要先同步一下窗口
-std::vector<std::pair<std::string, int>> SlidingWindow::getTopK(int k)
-{   
+void SlidingWindow::addBatch(const WindowBatch &batch)
+{
+    if (batch.empty()) {
+        return;
+    }
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    std::lock_guard<std::mutex> lock(mutex_);
+    // 1. 按批内顺序推算每一秒合并时的“当前时间”，判断是否迟到，再一次性推进全局时间
+    size_t num_seconds = batch.secondCount();
+    thread_local std::vector<char> accepted;
+    accepted.resize(num_seconds);
 
-    //处理还没有处理的迟到timeslot
-    processDelayedData();
+    unsigned int now = max_event_time.load();
+    for (size_t i = 0; i < num_seconds; ++i) {
+        unsigned int ts = batch.second(i).timestamp;
+        if (ts > now) {
+            now = ts;
+        }
+        accepted[i] = (now <= ts + max_delay_);
+        if (!accepted[i]) {
+            spdlog::warn("SlidingWindow  Data too late: " + std::to_string(ts) + " vs current: " + std::to_string(now));
+        }
+    }
 
-    // 【异常处理】检查 K 值合法性
-    if (k <= 0) {
-        spdlog::warn("Invalid K value: {}, reset to default K=10", k);
-        k = 1;
+    bool advanced=false;
+    now=advanceTime(batch.maxTimestamp(), advanced);
+    if (advanced) {
+        evictAllShards(now);
     }
 
-    std::vector<std::pair<std::string, int>> result;
-    result.reserve(word_count_.size());
+    // 2. 按分片拆分（局部 ID），ends 记录每一秒在 deltas 中的结束位置
+    struct ShardPart {
+        std::vector<std::pair<WordId,int>> deltas;
+        std::vector<size_t> ends;
+    };
+    thread_local std::vector<ShardPart> parts;
+    size_t n = shards_.size();
+    if (parts.size() < n) {
+        parts.resize(n);
+    }
+    for (size_t s = 0; s < n; ++s) {
+        parts[s].deltas.clear();
+        parts[s].ends.clear();
+    }
+    for (size_t i = 0; i < num_seconds; ++i) {
+        if (accepted[i]) {
+            for (const auto& delta : batch.second(i).deltas) {
+                parts[delta.first % n].deltas.emplace_back(static_cast<WordId>(delta.first / n), delta.second);
+            }
+        }
+        for (size_t s = 0; s < n; ++s) {
+            parts[s].ends.push_back(parts[s].deltas.size());
+        }
+    }
+
+    // 3. 每个分片加一次锁：先淘汰到最新时间，再逐秒累加
+    //    （早于淘汰线的秒逐条 addData 时也会在本批结束前被淘汰，直接跳过结果相同）
+    for (size_t s = 0; s < n; ++s) {
+        const ShardPart& part = parts[s];
+        if (part.deltas.empty()) {
+            continue;
+        }
 
-    for (const auto& kv : word_count_) {
-    result.emplace_back(kv.first, kv.second);
+        Shard& shard = *shards_[s];
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        evictExpiredData(shard, now);
+        size_t begin = 0;
+        for (size_t i = 0; i < num_seconds; ++i) {
+            size_t end = part.ends[i];
+            if (begin == end) {
+                continue;
+            }
+            unsigned int ts = batch.second(i).timestamp;
+            if (ts >= shard.next_expire_) {
+                for (size_t j = begin; j < end; ++j) {
+                    incrementWord(shard, part.deltas[j].first, ts, part.deltas[j].second);
+                }
+            }
+            begin = end;
+        }
     }
+    commitVersion();
+    slots_added_.fetch_add(batch.slotCount(), std::memory_order_release);
 
-    std::sort(result.begin(), result.end(),
-    [](const auto& a, const auto& b) {
-    return a.second > b.second;
-    });
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    auto perf_logger = spdlog::get("perf");
+    if (perf_logger) {
+        perf_logger->info("{},window_addbatch_ms,{:.3f}", std::time(nullptr), duration_ms);
+        perf_logger->info("{},window_batch_slots,{}", std::time(nullptr), batch.slotCount());
+    }
+
+    if (duration_ms > 50.0) {
+        spdlog::warn("Slow window batch update: {:.2f}ms (threshold: 50ms, slots: {})", 
+                     duration_ms, batch.slotCount());
+    }
+}
+
+unsigned int SlidingWindow::advanceTime(unsigned int ts, bool &advanced)
+{
+    advanced=false;
+    unsigned int now=max_event_time.load();
+    while (ts > now) {
+        if (max_event_time.compare_exchange_weak(now, ts)) {
+            now=ts;
+            advanced=true;
+            break;
+        }
+    }
+    return now;
+}
+
+void SlidingWindow::evictAllShards(unsigned int now)
+{
+    // 单分片时由写入路径自行淘汰；多分片时避免没有新词写入的分片残留过期数据
+    if (shards_.size() == 1) {
+        return;
+    }
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex_);
+        evictExpiredData(*shard, now);
+    }
+}
 
+void SlidingWindow::addToShard(Shard &shard, const std::vector<WordId> &local_ids, unsigned int ts, unsigned int now)
+{
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+
+    // 先淘汰过期数据（以 max_event_time 为基准），腾出环形数组中的桶
+    evictExpiredData(shard, now);
+
+    // 已经落在窗口之外
+    if (ts < shard.next_expire_) {
+        spdlog::debug("SlidingWindow  Data outside window: {} vs expire: {}", ts, shard.next_expire_);
+        return;
+    }
 
-    if (static_cast<int>(result.size()) > k) {
-    result.resize(k);
+    // 累加当前时间槽中的词频，并按秒聚合到桶中
+    for (WordId id : local_ids) {
+        incrementWord(shard, id, ts);
     }
+}
+
+//查询时要先同步一下窗口
+std::vector<std::pair<WordId, int>> SlidingWindow::getTopK(int k)
+{   
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // 【异常处理】检查 K 值合法性
+    if (k <= 0) {
+        spdlog::warn("Invalid K value: {}, reset to default K=10", k);
+        k = 1;
+    }
+    size_t want = static_cast<size_t>(k);
+
+    // 更大的 K：之后重建的快照都按它保存
+    size_t cur = snapshot_k_.load();
+    while (cur < want && !snapshot_k_.compare_exchange_weak(cur, want)) {
+    }
+
+    // 快照是最新版本且覆盖本次 K 时直接取前缀，不加任何锁
+    bool hit = true;
+    std::shared_ptr<const Snapshot> snap = currentSnapshot(want, hit);
+    std::vector<std::pair<WordId, int>> result(
+        snap->topk.begin(), snap->topk.begin() + std::min(want, snap->topk.size()));
 
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
@@ -102,110 +263,267 @@ std::vector<std::pair<std::string, int>> SlidingWindow::getTopK(int k)
     if (perf_logger) {
         perf_logger->info("{},topk_query_ms,{:.3f}", std::time(nullptr), duration_ms);
         perf_logger->info("{},topk_k_value,{}", std::time(nullptr), k);
+        perf_logger->info("{},topk_cache_hit,{}", std::time(nullptr), hit ? 1 : 0);
     }
     
-    spdlog::debug("Top-K query completed in {:.3f}ms", duration_ms);
+    spdlog::debug("Top-K query completed in {:.3f}ms (snapshot {})", duration_ms, hit ? "hit" : "miss");
 
     return result;
 }
 
+std::shared_ptr<SlidingWindow::Snapshot> SlidingWindow::buildSnapshot(uint64_t version, size_t k) const
+{
+    // 版本号由调用方在加锁读取之前取得：其间若有新的写入，快照只会多包含数据，
+    // 之后的查询发现版本更高时会再重建一次
+    auto snap = std::make_shared<Snapshot>();
+    snap->version = version;
+    snap->k = k;
+    std::vector<std::pair<WordId, int>>& result = snap->topk;
+
+    // 各分片取前 K 个候选（局部 ID 还原为全局 ID），再合并取全局前 K 个
+    size_t n = shards_.size();
+    std::vector<std::pair<WordId, int>> part;
+    for (size_t i = 0; i < n; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(shards_[i]->mutex_);
+            const WordCounter& counter = *shards_[i]->word_count_;
+            snap->total += counter.total();
+            snap->unique += counter.unique();
+            if (k == 0) {
+                continue;
+            }
+            if (n == 1) {
+                counter.topK(k, result);
+                continue;
+            }
+            counter.topK(k, part);
+        }
+        for (const auto& kv : part) {
+            result.emplace_back(static_cast<WordId>(kv.first * n + i), kv.second);
+        }
+    }
+
+    if (n > 1) {
+        size_t keep = std::min(result.size(), k);
+        std::partial_sort(result.begin(), result.begin() + keep, result.end(),
+            [](const auto& a, const auto& b) {
+                return a.second > b.second;
+            });
+        result.resize(keep);
+    }
+    return snap;
+}
+
+std::shared_ptr<const SlidingWindow::Snapshot> SlidingWindow::currentSnapshot(size_t want, bool &hit) const
+{
+    // 调用前已完成的写入都不晚于该版本
+    uint64_t version = version_.load(std::memory_order_acquire);
+    hit = true;
+    while (true) {
+        std::shared_ptr<const Snapshot> snap = std::atomic_load(&snapshot_);
+        if (snap->version >= version && (snap->k >= want || snap->topk.size() < snap->k)) {
+            return snap;
+        }
+        hit = false;
+
+        bool expected = false;
+        if (rebuilding_.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            // 抢到重建权后再检查一次：等待期间其他查询方可能已发布满足要求的快照
+            snap = std::atomic_load(&snapshot_);
+            if (snap->version < version || (snap->k < want && snap->topk.size() >= snap->k)) {
+                size_t k = std::max(snapshot_k_.load(), want);
+                std::shared_ptr<const Snapshot> fresh = buildSnapshot(version_.load(std::memory_order_acquire), k);
+                publishSnapshot(fresh);
+                snap = fresh;
+            }
+            rebuilding_.store(false, std::memory_order_release);
+            return snap;
+        }
+        // 其他查询方正在重建：等它发布后重新检查
+        std::this_thread::yield();
+    }
+}
+
+void SlidingWindow::publishSnapshot(std::shared_ptr<const Snapshot> snap) const
+{
+    std::shared_ptr<const Snapshot> cur = std::atomic_load(&snapshot_);
+    while (cur->version < snap->version || (cur->version == snap->version && cur->k < snap->k)) {
+        if (std::atomic_compare_exchange_weak(&snapshot_, &cur, snap)) {
+            return;
+        }
+    }
+}
+
+void SlidingWindow::commitVersion()
+{
+    // 写入路径不再逐分片加锁重建快照，只让当前快照失效
+    version_.fetch_add(1, std::memory_order_acq_rel);
+}
+
 int SlidingWindow::getWordCount(const std::string &word) const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = word_count_.find(word);
-    return (it != word_count_.end()) ? it->second : 0;
+    WordId id;
+    if (!WordDict::instance().find(word, id)) {
+        return 0;
+    }
+    return getWordCount(id);
+}
+
+int SlidingWindow::getWordCount(WordId id) const
+{
+    const Shard& shard = *shards_[id % shards_.size()];
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    return shard.word_count_->count(static_cast<WordId>(id / shards_.size()));
 }
 
 size_t SlidingWindow::getTotalWords() const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    size_t total = 0;
-    for (const auto& kv : word_count_) {
-        total += kv.second;
-    }
-    return total;
+    bool hit;
+    return currentSnapshot(0, hit)->total;
 }
 
 size_t SlidingWindow::getUniqueWords() const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return word_count_.size();
+    bool hit;
+    return currentSnapshot(0, hit)->unique;
 }
 
 unsigned int SlidingWindow::currentTime() const
 {
-    return max_event_time;
+    return max_event_time.load();
+}
+
+size_t SlidingWindow::slotsAdded() const
+{
+    return slots_added_.load(std::memory_order_acquire);
 }
 
-void SlidingWindow::evictExpiredData(unsigned int max_event_time)
+uint64_t SlidingWindow::version() const
+{
+    return version_.load(std::memory_order_acquire);
+}
+
+void SlidingWindow::evictExpiredData(Shard &shard, unsigned int max_event_time)
 {
     unsigned int expire_time = (max_event_time > window_size_)? (max_event_time - window_size_): 0;
+    if (expire_time <= shard.next_expire_) {
+        return;
+    }
 
+    // 近似模式没有逐秒桶，由计数器整段淘汰
+    if (shard.word_count_->windowed()) {
+        shard.word_count_->expireBefore(expire_time);
+        shard.next_expire_ = expire_time;
+        return;
+    }
+
+    unsigned int ring_size = static_cast<unsigned int>(shard.time_ring_.size());
+    if (expire_time - shard.next_expire_ > ring_size) {
+        // 跨度超过一整圈（输入中断超过窗口）：各桶的时间戳不一定落在最后一圈内，
+        // 按秒推进会跳过它们，改为把每个桶检查一次，淘汰所有早于淘汰线的桶
+        for (auto& bucket : shard.time_ring_) {
+            if (bucket.used && bucket.timestamp < expire_time) {
+                evictBucket(shard, bucket);
+            }
+        }
+        shard.next_expire_ = expire_time;
+        return;
+    }
 
-    // map 是按时间戳升序排列的，方便从最早时间开始淘汰
-    auto it = time_index_.begin();
-    while (it != time_index_.end() && it->first < expire_time) {
-        // 对该时间槽内的每一个词进行词频递减
-        for (const auto& word : it->second) {
-            decrementWord(word);
+    // 逐秒淘汰：每秒对应一个桶，桶内是已聚合的 (词, 次数)
+    for (unsigned int t = shard.next_expire_; t < expire_time; ++t) {
+        SecondBucket& bucket = shard.time_ring_[t % ring_size];
+        if (!bucket.used || bucket.timestamp != t) {
+            continue;
         }
-        it = time_index_.erase(it);
+        evictBucket(shard, bucket);
     }
+    shard.next_expire_ = expire_time;
 }
 
-void SlidingWindow::decrementWord(const std::string &word)
+void SlidingWindow::evictBucket(Shard &shard, SecondBucket &bucket)
 {
-    auto it = word_count_.find(word);
-    if (it != word_count_.end()) {
-        if (it->second > 50) {
-            spdlog::debug("Evicting word: '{}' (frequency was: {})", word, it->second);
+    for (const auto& delta : bucket.deltas) {
+        decrementWord(shard, delta.first, delta.second);
+    }
+    bucket.deltas.clear();
+    bucket.used = false;
+}
+
+SlidingWindow::SecondBucket &SlidingWindow::bucketFor(Shard &shard, unsigned int ts)
+{
+    SecondBucket& bucket = shard.time_ring_[ts % shard.time_ring_.size()];
+    if (!bucket.used || bucket.timestamp != ts) {
+        // 过期桶通常已在 evictExpiredData 中清空；若仍有数据则先减去再复用，保证计数不泄漏
+        if (bucket.used) {
+            evictBucket(shard, bucket);
         }
-        if (--(it->second) == 0) {
-            word_count_.erase(it);
+        bucket.timestamp = ts;
+        bucket.used = true;
+    }
+    return bucket;
+}
+
+void SlidingWindow::decrementWord(Shard &shard, WordId local_id, int count)
+{
+    int current = shard.word_count_->count(local_id);
+    if (current > 0) {
+        if (current > 50) {
+            spdlog::debug("Evicting word: local id={} (frequency was: {}, evicted: {})", local_id, current, count);
         }
+        shard.word_count_->add(local_id, -count);
+    }
+}
+
+void SlidingWindow::incrementWord(Shard &shard, WordId local_id, unsigned int ts, int count)
+{
+    if (shard.word_count_->windowed()) {
+        shard.word_count_->addAt(ts, local_id, count);
+        return;
+    }
+
+    shard.word_count_->add(local_id, count);
+
+    if (local_id >= shard.last_ts_.size()) {
+        shard.last_ts_.resize(local_id + 1, 0);
+        shard.last_slot_.resize(local_id + 1, 0);
+    }
+
+    // 该词最近一次就写在这个桶里：直接累加，否则追加一项
+    // （迟到数据写入旧桶后会覆盖索引，之后最多多出一项重复记录，淘汰结果不变）
+    SecondBucket& bucket = bucketFor(shard, ts);
+    uint32_t slot = shard.last_slot_[local_id];
+    if (shard.last_ts_[local_id] == ts && slot < bucket.deltas.size() && bucket.deltas[slot].first == local_id) {
+        bucket.deltas[slot].second += count;
+    } else {
+        shard.last_ts_[local_id] = ts;
+        shard.last_slot_[local_id] = static_cast<uint32_t>(bucket.deltas.size());
+        bucket.deltas.emplace_back(local_id, count);
     }
 }
 
 size_t SlidingWindow::estimateMemoryUsage() const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     size_t memory = 0;
-    
-    // word_count_ 的内存
-    memory += word_count_.size() * (50 + sizeof(int));
-    
-    // time_index_ 的内存
-    for (const auto& kv : time_index_) {
-        memory += sizeof(unsigned int);
-        memory += kv.second.size() * 50;
+
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex_);
+
+        // word_count_ 的内存（精确：词频表 + 索引堆；近似：总计数矩阵 + 各时间段计数矩阵 + 候选堆）
+        memory += shard->word_count_->memoryUsage();
+
+        // 环形桶的内存
+        for (const auto& bucket : shard->time_ring_) {
+            memory += sizeof(SecondBucket);
+            memory += bucket.deltas.capacity() * sizeof(pair<WordId,int>);
+        }
+        memory += shard->last_ts_.capacity() * sizeof(unsigned int);
+        memory += shard->last_slot_.capacity() * sizeof(uint32_t);
     }
+
+    // 当前快照（读者仍持有的旧快照不计）
+    std::shared_ptr<const Snapshot> snap = std::atomic_load(&snapshot_);
+    memory += sizeof(Snapshot) + snap->topk.capacity() * sizeof(pair<WordId,int>);
     
     return memory;
 }
-
-void SlidingWindow::processDelayedData() 
-{   
-   
-    for (auto it = delayed_buffer_.begin(); it != delayed_buffer_.end();) {
-        unsigned int ts = it->first;
-        
-        // 检查是否在窗口内
-        if (ts >= max_event_time - window_size_) {
-            // 合并到时间索引
-            for (const auto& word : it->second) {
-                ++word_count_[word];
-            }
-            
-            time_index_[ts].insert(
-                time_index_[ts].end(),
-                it->second.begin(),
-                it->second.end()
-            );
-            
-            it = delayed_buffer_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "StatisticsThread.h"
+#include "WordDict.h"
 #include "spdlog/spdlog.h"
 #include <chrono>
+#include <algorithm>
 
 void StatisticsThread::run()
 {
@@ -16,13 +18,24 @@ void StatisticsThread::run()
     double total_window_update_ms = 0.0;
     double total_query_process_ms = 0.0;
 
+    std::vector<TimeSlot> slots;//一次从 Buffer 批量取出的时间槽
+    slots.reserve(batch_slots_);
+
     while(true){
-        TimeSlot slot;
+        // 缓冲区暂时为空：先把手里的微批合并进窗口、已缓冲的查询结果写入文件，再阻塞等待，避免数据滞留
+        if (buffer_.empty()) {
+            if (!batch_.empty()) {
+                total_window_update_ms += flushBatch();
+                processQueries();
+            }
+            query_handler_.flush();
+        }
 
-        //Buffer pop 计时
+        //Buffer pop 计时（一次取出至多一个微批的时间槽）
         auto pop_start = std::chrono::high_resolution_clock::now();
-                
-        if (!buffer_.pop(slot)) {
+
+        slots.clear();
+        if (buffer_.popBatch(slots, batch_slots_) == 0) {
             //Buffer 已空且输入结束
             spdlog::info("StatisticsThread [{}]: Buffer closed, exiting", thread_id_);
             break;
@@ -36,32 +49,41 @@ void StatisticsThread::run()
                         thread_id_, pop_ms);
         }
 
-        //更新滑动窗口
-        auto window_start = std::chrono::high_resolution_clock::now();
-        
-        sliding_window_.addData(slot);
-        
-        auto window_end = std::chrono::high_resolution_clock::now();
-        auto window_ms = std::chrono::duration<double, std::milli>(
-            window_end - window_start).count();
-        total_window_update_ms += window_ms;
-        
-        spdlog::debug("StatisticsThread [{}]: Window updated with timestamp={}, time={:.2f}ms", 
-                     thread_id_, slot.timestamp, window_ms);
+        for (const TimeSlot& slot : slots) {
+            //已到期的查询（其之前的时间槽都已在窗口或本地微批中）在加入新时间槽之前执行
+            if (queryDue(std::max(batch_.maxTimestamp(), sliding_window_.currentTime()))) {
+                total_window_update_ms += flushBatch();
+                processQueries();
+            }
 
-        //执行查询
-        auto query_start = std::chrono::high_resolution_clock::now();
-        
-        processQueries();
+            //累积到本地微批
+            if (batch_.empty()) {
+                batch_start_ = std::chrono::high_resolution_clock::now();
+            }
+            batch_.add(slot);
 
-        
-        auto query_end = std::chrono::high_resolution_clock::now();
-        auto query_ms = std::chrono::duration<double, std::milli>(
-            query_end - query_start).count();
-        total_query_process_ms += query_ms;
+            //微批已满 / 滞留过久 / 有查询在等待这个时间点：合并进滑动窗口并执行查询
+            auto batch_age_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - batch_start_).count();
+
+            if (batch_.slotCount() >= batch_slots_ || batch_age_ms >= max_batch_delay_ms_ ||
+                queryDue(batch_.maxTimestamp())) {
+                total_window_update_ms += flushBatch();
+
+                //执行查询
+                auto query_start = std::chrono::high_resolution_clock::now();
+                
+                processQueries();
+
+                auto query_end = std::chrono::high_resolution_clock::now();
+                auto query_ms = std::chrono::duration<double, std::milli>(
+                    query_end - query_start).count();
+                total_query_process_ms += query_ms;
+            }
+        }
 
-        processed_slots++;
-        processed_since_last_report++;
+        processed_slots += slots.size();
+        processed_since_last_report += slots.size();
 
         // 性能定期报告（每5秒）
         auto now = std::chrono::high_resolution_clock::now();
@@ -104,6 +126,10 @@ void StatisticsThread::run()
 
     }
 
+    // 合并最后一个微批，并执行此时已到期的查询
+    flushBatch();
+    processQueries();
+
     // 线程结束统计
     auto thread_end_time = std::chrono::high_resolution_clock::now();
     auto total_duration = std::chrono::duration<double>(
@@ -129,17 +155,48 @@ void StatisticsThread::run()
     spdlog::info("<<< StatisticsThread [{}] Terminated <<<", thread_id_);
 }
 
+double StatisticsThread::flushBatch()
+{
+    if (batch_.empty()) {
+        return 0.0;
+    }
+
+    auto window_start = std::chrono::high_resolution_clock::now();
+
+    sliding_window_.addBatch(batch_);
+
+    auto window_end = std::chrono::high_resolution_clock::now();
+    auto window_ms = std::chrono::duration<double, std::milli>(
+        window_end - window_start).count();
+
+    spdlog::debug("StatisticsThread [{}]: Window updated with {} slots (max timestamp={}), time={:.2f}ms", 
+                 thread_id_, batch_.slotCount(), batch_.maxTimestamp(), window_ms);
+
+    batch_.clear();
+    return window_ms;
+}
+
+bool StatisticsThread::queryDue(unsigned int ts)
+{
+    size_t slots = sliding_window_.slotsAdded() + batch_.slotCount();
+    std::lock_guard<std::mutex> lock(query_mutex_);
+    return !query_queue_.empty() && query_queue_.front().timestamp <= ts &&
+           query_queue_.front().after_slots <= slots;
+}
+
 void StatisticsThread::processQueries()
 {
     std::lock_guard<std::mutex> lock(query_mutex_);
 
     unsigned int ts = sliding_window_.currentTime();
+    size_t slots = sliding_window_.slotsAdded();
     int executed_count = 0;
 
     while(!query_queue_.empty()){
         QueryCommand query = query_queue_.front();
 
-        if(query.timestamp <= ts){
+        //查询时刻已到，且输入中位于它之前的时间槽都已合并进窗口
+        if(query.timestamp <= ts && query.after_slots <= slots){
             auto topk = sliding_window_.getTopK(query.k);
 
             // 使用滑动窗口时间
@@ -150,7 +207,7 @@ void StatisticsThread::processQueries()
             if (op_logger) {
                 std::string result_str;
                 for (size_t i = 0; i < topk.size() && i < 5; ++i) {
-                    result_str += topk[i].first + "(" + std::to_string(topk[i].second) + ")";
+                    result_str += WordDict::instance().word(topk[i].first) + "(" + std::to_string(topk[i].second) + ")";
                     if (i < std::min(topk.size(), size_t(5)) - 1) result_str += ", ";
                 }
                 if (topk.size() > 5) result_str += "...";
@@ -172,13 +229,16 @@ void StatisticsThread::processQueries()
     }
 }
 
-StatisticsThread::StatisticsThread(int thread_id, Buffer<TimeSlot> &buffer, SlidingWindow &sliding_window, QueryHandler &query_handler, std::queue<QueryCommand> &query_queue, std::mutex &query_mutex)
+StatisticsThread::StatisticsThread(int thread_id, Buffer<TimeSlot> &buffer, SlidingWindow &sliding_window, QueryHandler &query_handler, std::queue<QueryCommand> &query_queue, std::mutex &query_mutex, size_t batch_slots, unsigned int max_batch_delay_ms)
 : thread_id_(thread_id),
       buffer_(buffer),
       sliding_window_(sliding_window),
       query_handler_(query_handler),
       query_queue_(query_queue),
-      query_mutex_(query_mutex)
+      query_mutex_(query_mutex),
+      batch_slots_(batch_slots > 0 ? batch_slots : 1),
+      max_batch_delay_ms_(max_batch_delay_ms)
 {
     spdlog::info("=== StatisticsThread [{}] Initialized ===", thread_id_);
+    spdlog::info("Micro-batch: {} slots, max delay {}ms", batch_slots_, max_batch_delay_ms_);
 }
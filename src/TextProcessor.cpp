@@ -1,35 +1,80 @@
 #include "TextProcessor.h"
+#include "WordDict.h"
 #include "spdlog/spdlog.h"
 #include <chrono>
+#include <ctime>
 
-TextProcessor::TextProcessor(const std::string &dict_path,bool enable_pos_filter):enable_pos_filter_(enable_pos_filter)
+namespace {
+
+//参与子串屏蔽的敏感词最少字符数
+constexpr size_t MIN_MASK_CHARS = 2;
+
+//UTF-8 字符数（不计续字节）
+size_t utf8Length(std::string_view s)
+{
+    size_t n = 0;
+    for (unsigned char c : s) {
+        n += (c & 0xC0) != 0x80;
+    }
+    return n;
+}
+
+}
+
+TextProcessor::TextProcessor(const std::string &dict_path,bool enable_pos_filter,bool mask_sensitive)
+    :enable_pos_filter_(enable_pos_filter),mask_sensitive_(mask_sensitive)
 {
 try {
 
         spdlog::info("=== TextProcessor Initializing ===");
         spdlog::info("Dictionary path: {}", dict_path);
         spdlog::info("POS filter: {}", enable_pos_filter_ ? "Enabled" : "Disabled");
+        spdlog::info("Sensitive substring masking: {}", mask_sensitive_ ? "Enabled" : "Disabled");
         // 初始化 jieba 分词器（加载 5 个核心词典）
+        // 若词典目录下有与词典文件匹配的二进制快照（bin/dict_snapshot 生成），直接从快照加载，跳过文本解析和建树
+        auto load_start = std::chrono::high_resolution_clock::now();
         jieba_ = std::make_unique<cppjieba::Jieba>(
             dict_path + "jieba.dict.utf8",       // 主词典
             dict_path + "hmm_model.utf8",        // HMM 模型
             dict_path + "user.dict.utf8",        // 用户自定义词典
             dict_path + "idf.utf8",              // IDF 权重文件（用于关键词提取）
-            dict_path + "stop_words.utf8"        // 停用词表
+            dict_path + "stop_words.utf8",       // 停用词表
+            dict_path + DICT_SNAPSHOT_FILE       // 词典快照（不存在或已过期时回退到文本词典）
         );
+        auto load_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - load_start).count();
+        spdlog::info("Jieba loaded from {} in {:.2f}ms",
+                     jieba_->LoadedFromSnapshot() ? "snapshot" : "text dictionaries", load_ms);
+        auto perf_logger = spdlog::get("perf");
+        if (perf_logger) {
+            perf_logger->info("{},dict_load_ms,{:.2f}", std::time(nullptr), load_ms);
+            perf_logger->info("{},dict_from_snapshot,{}", std::time(nullptr), jieba_->LoadedFromSnapshot() ? 1 : 0);
+        }
 
         if(enable_pos_filter_){
-            initValidPOS();
+            initValidPOS(dict_path+"valid_pos.utf8");
             spdlog::info("Valid POS tags loaded: {} types", valid_pos_.size());
         }
+        buildPOSMask();
         
-        // 加载停用词到内存哈希表
+        // 加载停用词、敏感词，编译为过滤表
         loadStopWords(dict_path+"stop_words.utf8");
         loadSensitiveWords(dict_path+"sensitive_words.utf8");
+        word_filter_.build();
+        if (mask_sensitive_) {
+            auto build_start = std::chrono::high_resolution_clock::now();
+            sensitive_matcher_.build();
+            spdlog::info("Sensitive matcher built in {:.2f}ms: {} patterns, {} states, {:.2f}KB",
+                         std::chrono::duration<double, std::milli>(
+                             std::chrono::high_resolution_clock::now() - build_start).count(),
+                         sensitive_matcher_.size(), sensitive_matcher_.states(),
+                         sensitive_matcher_.memoryUsage() / 1024.0);
+        }
         
         spdlog::info(">>> TextProcessor Initialized Successfully <<<");
-        spdlog::info("Stop words count: {}", stop_words_.size());
-        spdlog::info("Sensitive words count: {}", sensitive_words_.size());
+        spdlog::info("Stop words count: {}", word_filter_.count(WordFilter::STOP));
+        spdlog::info("Sensitive words count: {}", word_filter_.count(WordFilter::SENSITIVE));
+        spdlog::info("Word filter memory: {:.2f}KB", word_filter_.memoryUsage() / 1024.0);
     
     } catch (const std::exception& e) {
         spdlog::critical("TextProcessor initialization failed: {}", e.what());
@@ -39,7 +84,7 @@ try {
 
 TextProcessor::~TextProcessor()=default;
 
-std::vector<std::string> TextProcessor::process(const std::string &text)
+std::vector<std::string> TextProcessor::process(const std::string &text) const
 {   
     auto start_time = std::chrono::high_resolution_clock::now();
 
@@ -53,32 +98,26 @@ std::vector<std::string> TextProcessor::process(const std::string &text)
                   original_length, 
                   text.substr(0, std::min(size_t(50), original_length)));
 
-    //分词
-    std::vector<std::string> raw_words;
+    //分词（只得到偏移/长度，不构造字符串）
     auto segment_start = std::chrono::high_resolution_clock::now();
 
-    try {
-        jieba_->Cut(text, raw_words, true);  // true = 使用 HMM
-    } catch (const std::exception& e) {
-        //分词失败
-        spdlog::error("Segmentation failed: {} | Text: '{}'", 
-                     e.what(), text.substr(0, 100));
-        return {};
-    }
+    std::string_view view = maskSensitive(text);
+    const auto& spans = tagSpans(view);
 
     auto segment_end = std::chrono::high_resolution_clock::now();
     auto segment_ms = std::chrono::duration<double, std::milli>(segment_end - segment_start).count();
 
     spdlog::debug("Segmentation result: {} words from {} chars", 
-                  raw_words.size(), original_length);
+                  spans.size(), original_length);
 
-    //过滤和清洗
+    //过滤和清洗：在视图上判断，只为保留下来的词构造字符串
     std::vector<std::string> result;
-    result.reserve(raw_words.size());  // 预分配空间
+    result.reserve(spans.size());  // 预分配空间
     
-    for (const auto& word : raw_words) {
+    for (const auto& span : spans) {
+        std::string_view word(view.data() + span.offset, span.length);
         if (isValidWord(word)) {
-            result.push_back(word);
+            result.emplace_back(word);
         }
     }
    
@@ -93,7 +132,7 @@ std::vector<std::string> TextProcessor::process(const std::string &text)
         perf_logger->info("{},segment_ms,{:.3f}", std::time(nullptr), segment_ms);
         perf_logger->info("{},filter_ms,{:.3f}", std::time(nullptr), filter_ms);
         perf_logger->info("{},text_length,{}", std::time(nullptr), original_length);
-        perf_logger->info("{},words_segmented,{}", std::time(nullptr), raw_words.size());
+        perf_logger->info("{},words_segmented,{}", std::time(nullptr), spans.size());
         perf_logger->info("{},words_valid,{}", std::time(nullptr), result.size());
     }
     
@@ -108,7 +147,7 @@ std::vector<std::string> TextProcessor::process(const std::string &text)
     return result;
 }
 
-std::vector<std::string> TextProcessor::processWithPOS(const std::string &text)
+std::vector<std::string> TextProcessor::processWithPOS(const std::string &text) const
 {
     //计时开始
     auto start_time = std::chrono::high_resolution_clock::now();
@@ -121,27 +160,18 @@ std::vector<std::string> TextProcessor::processWithPOS(const std::string &text)
 
     spdlog::debug("Processing text with POS tagging: length={}", text.length());
 
-    // 标注词性
-    std::vector<std::pair<std::string, std::string>> tagged_words;
-    try {
-        jieba_->Tag(text, tagged_words);
-    } catch (const std::exception& e) {
-        // 【异常处理】词性标注失败
-        spdlog::error("POS tagging failed: {} | Text: '{}'", 
-                     e.what(), text.substr(0, 100));
-        return {};
-    }
+    // 屏蔽敏感词子串后标注词性
+    std::string_view view = maskSensitive(text);
+    const auto& spans = tagSpans(view);
 
-    // 过滤
+    // 过滤：词性按 ID 判断，词在视图上判断，只为保留下来的词构造字符串
     std::vector<std::string> result;
-    result.reserve(tagged_words.size());
+    result.reserve(spans.size());
     
-    for (const auto& pair : tagged_words) {
-        const std::string& word = pair.first;
-        const std::string& pos = pair.second;
-
-        if(isValidWord(word) && isValidPOS(pos)){
-            result.push_back(word);
+    for (const auto& span : spans) {
+        std::string_view word(view.data() + span.offset, span.length);
+        if(isValidPOS(span.tag_id) && isValidWord(word)){
+            result.emplace_back(word);
         }
     }
 
@@ -157,6 +187,66 @@ std::vector<std::string> TextProcessor::processWithPOS(const std::string &text)
     return result;
 }
 
+std::vector<WordId> TextProcessor::processWithPOSToIds(std::string_view text) const
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    if (text.empty()) {
+        return {};
+    }
+
+    // 直接在输入（可能是 InputHandler 的映射区）上分词，保留下来的词直接驻留为 ID，全程不构造词字符串
+    // 启用屏蔽时，只有命中敏感词的行才会复制一份
+    text = maskSensitive(text);
+    const auto& spans = tagSpans(text);
+
+    std::vector<WordId> result;
+    result.reserve(spans.size());
+    WordDict& dict = WordDict::instance();
+    for (const auto& span : spans) {
+        std::string_view word(text.data() + span.offset, span.length);
+        if (isValidPOS(span.tag_id) && isValidWord(word)) {
+            result.push_back(dict.intern(word));
+        }
+    }
+
+    auto duration_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start_time).count();
+    auto perf_logger = spdlog::get("perf");
+    if (perf_logger) {
+        perf_logger->info("{},preprocess_pos_ms,{:.3f}", std::time(nullptr), duration_ms);
+    }
+
+    return result;
+}
+
+std::string_view TextProcessor::maskSensitive(std::string_view text) const
+{
+    if (!mask_sensitive_) {
+        return text;
+    }
+    thread_local std::string masked;
+    if (!sensitive_matcher_.mask(text, masked)) {
+        return text;
+    }
+    return masked;
+}
+
+const std::vector<cppjieba::TagSpan>& TextProcessor::tagSpans(std::string_view text) const
+{
+    // 每个线程复用同一个缓冲，稳态下不再分配
+    thread_local std::vector<cppjieba::TagSpan> spans;
+    try {
+        jieba_->Tag(text.data(), text.size(), spans);
+    } catch (const std::exception& e) {
+        // 【异常处理】分词/词性标注失败
+        spdlog::error("POS tagging failed: {} | Text: '{}'", 
+                     e.what(), text.substr(0, 100));
+        spans.clear();
+    }
+    return spans;
+}
+
 void TextProcessor::loadStopWords(const std::string &file_path)
 {   
     spdlog::info("Loading stop words from: {}", file_path);
@@ -170,6 +260,7 @@ void TextProcessor::loadStopWords(const std::string &file_path)
     
     //读取所有的停用词
     std::string line;
+    size_t loaded = 0;
     while (std::getline(file, line)) {
         // 移除 Windows 换行符 \r
         if (!line.empty() && line.back() == '\r') {
@@ -181,22 +272,23 @@ void TextProcessor::loadStopWords(const std::string &file_path)
         line.erase(line.find_last_not_of(" \t\n\r") + 1);
         
         if (!line.empty()) {
-            stop_words_.insert(line);
+            word_filter_.add(line, WordFilter::STOP);
+            ++loaded;
         }
     }
     
     file.close();
-    spdlog::info("Stop words loaded successfully: {} words", stop_words_.size());
+    spdlog::info("Stop words loaded successfully: {} words", loaded);
 }
 
-bool TextProcessor::isStopWord(const std::string &word) const
+bool TextProcessor::isStopWord(std::string_view word) const
 {
-    return stop_words_.find(word)!=stop_words_.end();
+    return word_filter_.contains(word, WordFilter::STOP);
 }
 
-bool TextProcessor::isSensitiveWord(const std::string &word) const
+bool TextProcessor::isSensitiveWord(std::string_view word) const
 {
-    return sensitive_words_.find(word)!=sensitive_words_.end();
+    return word_filter_.contains(word, WordFilter::SENSITIVE);
 }
 
 bool TextProcessor::isValidPOS(const std::string &pos) const
@@ -204,35 +296,58 @@ bool TextProcessor::isValidPOS(const std::string &pos) const
     return valid_pos_.find(pos) != valid_pos_.end();
 }
 
-void TextProcessor::initValidPOS()
+bool TextProcessor::isValidPOS(uint32_t tag_id) const
 {
-    // 保留的词性（实词为主）
-    valid_pos_ = {
-        // 名词类
-        "n",   // 普通名词（如：学生、电脑）
-        "nr",  // 人名（如：张三、李四）
-        "ns",  // 地名（如：北京、上海）
-        "nt",  // 机构名（如：清华大学）
-        "nz",  // 其他专名
-        
-        // 动词类
-        "v",   // 动词（如：学习、研究）
-        "vn",  // 名动词（如：调查、研究）
-        
-        // 形容词
-        "a",   // 形容词（如：美丽、快速）
-        "ad",  // 副形词（如：很、非常）
-        "an",  // 名形词（如：经济、政治）
-        
-        // 其他有意义词性
-        "i",   // 成语（如：一帆风顺）
-        "j",   // 简称（如：北大、清华）
-        "l",   // 习用语（如：按照、根据）
-        "eng", // 英文词
-        "x"    // 非语素字（保留，可能是专有名词）
-
-    };
-    spdlog::debug("Valid POS initialized: {} types", valid_pos_.size());
+    if (tag_id < pos_mask_tags_) {
+        return (valid_pos_mask_[tag_id >> 6] >> (tag_id & 63)) & 1;
+    }
+    // 运行时新增的词性（InsertUserWord）不在表中，按名字判断
+    return isValidPOS(jieba_->TagName(tag_id));
+}
+
+void TextProcessor::initValidPOS(const std::string &file_path)
+{
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file.is_open()) {
+        spdlog::warn("Cannot open valid POS file: {}, using built-in defaults", file_path);
+        // 默认保留的词性（实词为主），与 dict/valid_pos.utf8 一致
+        valid_pos_ = {
+            "n", "nr", "ns", "nt", "nz",    // 名词类
+            "v", "vn",                      // 动词类
+            "a", "ad", "an",                // 形容词
+            "i", "j", "l", "eng", "x"       // 成语、简称、习用语、英文词、非语素字
+        };
+        return;
+    }
+
+    valid_pos_.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        // 去掉注释和首尾空白
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        line.erase(0, line.find_first_not_of(" \t\n\r"));
+        line.erase(line.find_last_not_of(" \t\n\r") + 1);
+
+        if (!line.empty()) {
+            valid_pos_.insert(line);
+        }
+    }
+    spdlog::debug("Valid POS initialized from {}: {} types", file_path, valid_pos_.size());
+}
+
+void TextProcessor::buildPOSMask()
+{
+    // 词性表按 jieba 的词性 ID 展开成位图，过滤时不再做字符串哈希和比较
+    pos_mask_tags_ = jieba_->TagCount();
+    valid_pos_mask_.assign((pos_mask_tags_ + 63) / 64, 0);
+    for (size_t id = 0; id < pos_mask_tags_; ++id) {
+        if (isValidPOS(jieba_->TagName(static_cast<uint32_t>(id)))) {
+            valid_pos_mask_[id >> 6] |= uint64_t(1) << (id & 63);
+        }
+    }
 }
 
 void TextProcessor::loadSensitiveWords(const std::string &file_path)
@@ -246,6 +361,7 @@ void TextProcessor::loadSensitiveWords(const std::string &file_path)
     
     //读取所有的停用词
     std::string line;
+    size_t loaded = 0;
     while (std::getline(file, line)) {
         // 移除 Windows 换行符 \r
         if (!line.empty() && line.back() == '\r') {
@@ -257,15 +373,20 @@ void TextProcessor::loadSensitiveWords(const std::string &file_path)
         line.erase(line.find_last_not_of(" \t\n\r") + 1);
         
         if (!line.empty()) {
-            sensitive_words_.insert(line);
+            word_filter_.add(line, WordFilter::SENSITIVE);
+            // 单字（妈、爸等）作为子串会误伤大量正常文本，只参与整词过滤
+            if (mask_sensitive_ && utf8Length(line) >= MIN_MASK_CHARS) {
+                sensitive_matcher_.add(line);
+            }
+            ++loaded;
         }
     }
     
     file.close();
-    spdlog::info("Sensitive words loaded successfully: {} words", sensitive_words_.size());
+    spdlog::info("Sensitive words loaded successfully: {} words", loaded);
 }
 
-bool TextProcessor::isValidWord(const std::string &word) const
+bool TextProcessor::isValidWord(std::string_view word) const
 {   
     // 1. 过滤空字符串
     if (word.empty()) {
@@ -273,7 +394,7 @@ bool TextProcessor::isValidWord(const std::string &word) const
     }
     
     // 2. 过滤纯空白字符（空格、制表符、换行符等）
-    if (word.find_first_not_of(" \t\n\r") == std::string::npos) {
+    if (word.find_first_not_of(" \t\n\r") == std::string_view::npos) {
         return false;
     }
     
@@ -282,13 +403,8 @@ bool TextProcessor::isValidWord(const std::string &word) const
         return false;
     }
     
-    // 4. 停用词过滤
-    if (isStopWord(word)) {
-        return false;
-    }
-
-    // 5. 敏感词过滤
-    if (isSensitiveWord(word)) {
+    // 4. 停用词、敏感词过滤（同一张表，一次查找）
+    if (word_filter_.flags(word) != 0) {
         return false;
     }
     
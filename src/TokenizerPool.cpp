@@ -0,0 +1,120 @@
+#include "TokenizerPool.h"
+#include "spdlog/spdlog.h"
+#include <chrono>
+
+TokenizerPool::TokenizerPool(const TextProcessor &text_processor, size_t num_workers, size_t max_in_flight)
+: text_processor_(text_processor),
+  max_in_flight_(max_in_flight > 0 ? max_in_flight : (num_workers > 0 ? num_workers * 2 : 1))
+{
+    workers_.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+
+    spdlog::info("TokenizerPool started: {} workers, max {} chunks in flight",
+                 workers_.size(), max_in_flight_);
+}
+
+TokenizerPool::~TokenizerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    todo_cv_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void TokenizerPool::submit(std::vector<InputLine> &&lines)
+{
+    auto chunk = std::make_shared<Chunk>();
+    chunk->lines = std::move(lines);
+
+    //无工作线程：同步分词
+    if (workers_.empty()) {
+        tokenize(*chunk);
+        chunk->done = true;
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_flight_.push_back(std::move(chunk));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_flight_.push_back(chunk);
+        todo_.push_back(std::move(chunk));
+    }
+    todo_cv_.notify_one();
+}
+
+bool TokenizerPool::next(Chunk &out)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (in_flight_.empty()) {
+        return false;
+    }
+
+    //只等待最早提交的块，后面的块即使先完成也不能越过它
+    done_cv_.wait(lock, [this] { return in_flight_.front()->done; });
+
+    out = std::move(*in_flight_.front());
+    in_flight_.pop_front();
+    return true;
+}
+
+bool TokenizerPool::full() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_.size() >= max_in_flight_;
+}
+
+size_t TokenizerPool::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_.size();
+}
+
+void TokenizerPool::workerLoop()
+{
+    while (true) {
+        std::shared_ptr<Chunk> chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            todo_cv_.wait(lock, [this] { return stopping_ || !todo_.empty(); });
+            if (todo_.empty()) {
+                return;//stopping_ 且无剩余任务
+            }
+            chunk = std::move(todo_.front());
+            todo_.pop_front();
+        }
+
+        tokenize(*chunk);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            chunk->done = true;
+        }
+        done_cv_.notify_all();
+    }
+}
+
+void TokenizerPool::tokenize(Chunk &chunk)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    chunk.words.resize(chunk.lines.size());
+    for (size_t i = 0; i < chunk.lines.size(); ++i) {
+        const InputLine& line = chunk.lines[i];
+        if (!line.is_query) {
+            chunk.words[i] = text_processor_.processWithPOSToIds(line.text());
+        }
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    chunk.process_ms = std::chrono::duration<double, std::milli>(end - start).count();
+}
@@ -0,0 +1,136 @@
+#include "TopKCounter.h"
+#include <algorithm>
+#include <queue>
+
+void TopKCounter::add(WordId id, int delta)
+{
+    if (delta == 0) {
+        return;
+    }
+    if (id >= count_.size()) {
+        count_.resize(id + 1, 0);
+        pos_.resize(id + 1, NPOS);
+    }
+
+    int old_count = count_[id];
+    int new_count = old_count + delta;
+    if (new_count < 0) {
+        new_count = 0;
+    }
+    total_ = total_ - old_count + new_count;
+    count_[id] = new_count;
+
+    if (new_count == 0) {
+        if (pos_[id] != NPOS) {
+            remove(id);
+        }
+        return;
+    }
+
+    if (pos_[id] == NPOS) {
+        heap_.push_back(id);
+        pos_[id] = static_cast<uint32_t>(heap_.size() - 1);
+        siftUp(pos_[id]);
+    } else if (new_count > old_count) {
+        siftUp(pos_[id]);
+    } else {
+        siftDown(pos_[id]);
+    }
+}
+
+int TopKCounter::count(WordId id) const
+{
+    return (id < count_.size()) ? count_[id] : 0;
+}
+
+void TopKCounter::topK(size_t k, std::vector<std::pair<WordId, int>> &out) const
+{
+    out.clear();
+    if (heap_.empty() || k == 0) {
+        return;
+    }
+    out.reserve(std::min(k, heap_.size()));
+
+    // 堆中任一节点的词频不小于其子节点，所以从堆顶出发做最佳优先搜索：
+    // 每取出一个节点，只把它的两个子节点放入候选队列
+    auto cmp = [this](uint32_t a, uint32_t b) { return count_[heap_[a]] < count_[heap_[b]]; };
+    std::priority_queue<uint32_t, std::vector<uint32_t>, decltype(cmp)> frontier(cmp);
+    frontier.push(0);
+
+    while (!frontier.empty() && out.size() < k) {
+        uint32_t i = frontier.top();
+        frontier.pop();
+        out.emplace_back(heap_[i], count_[heap_[i]]);
+
+        size_t left = 2 * static_cast<size_t>(i) + 1;
+        if (left < heap_.size()) {
+            frontier.push(static_cast<uint32_t>(left));
+        }
+        if (left + 1 < heap_.size()) {
+            frontier.push(static_cast<uint32_t>(left + 1));
+        }
+    }
+}
+
+size_t TopKCounter::memoryUsage() const
+{
+    return count_.capacity() * sizeof(int)
+         + pos_.capacity() * sizeof(uint32_t)
+         + heap_.capacity() * sizeof(WordId);
+}
+
+void TopKCounter::siftUp(uint32_t i)
+{
+    WordId id = heap_[i];
+    int c = count_[id];
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (count_[heap_[parent]] >= c) {
+            break;
+        }
+        place(i, heap_[parent]);
+        i = parent;
+    }
+    place(i, id);
+}
+
+void TopKCounter::siftDown(uint32_t i)
+{
+    WordId id = heap_[i];
+    int c = count_[id];
+    size_t n = heap_.size();
+    while (true) {
+        size_t child = 2 * static_cast<size_t>(i) + 1;
+        if (child >= n) {
+            break;
+        }
+        if (child + 1 < n && higher(static_cast<uint32_t>(child + 1), static_cast<uint32_t>(child))) {
+            child++;
+        }
+        if (count_[heap_[child]] <= c) {
+            break;
+        }
+        place(i, heap_[child]);
+        i = static_cast<uint32_t>(child);
+    }
+    place(i, id);
+}
+
+void TopKCounter::remove(WordId id)
+{
+    uint32_t i = pos_[id];
+    WordId last = heap_.back();
+    heap_.pop_back();
+    pos_[id] = NPOS;
+    if (last == id) {
+        return;
+    }
+
+    // 用堆尾元素填补空位，再向上或向下调整
+    place(i, last);
+    if (i > 0 && count_[heap_[(i - 1) / 2]] < count_[last]) {
+        siftUp(i);
+    } else {
+        siftDown(i);
+    }
+}
@@ -0,0 +1,68 @@
+#include "WindowBatch.h"
+
+void WindowBatch::add(const TimeSlot &slot)
+{
+    if (slot_count_ == 0 || slot.timestamp > max_timestamp_) {
+        max_timestamp_ = slot.timestamp;
+    }
+    slot_count_++;
+    word_count_ += slot.words.size();
+
+    if (slot.words.empty()) {
+        return;
+    }
+
+    size_t idx = secondFor(slot.timestamp);
+    Second& sec = seconds_[idx];
+
+    for (WordId id : slot.words) {
+        if (id >= last_second_.size()) {
+            last_second_.resize(id + 1, 0);
+            last_slot_.resize(id + 1, 0);
+        }
+
+        // 该词最近一次就写在这一秒：直接累加，否则追加一项
+        uint32_t s = last_slot_[id];
+        if (last_second_[id] == idx && s < sec.deltas.size() && sec.deltas[s].first == id) {
+            ++sec.deltas[s].second;
+        } else {
+            last_second_[id] = static_cast<uint32_t>(idx);
+            last_slot_[id] = static_cast<uint32_t>(sec.deltas.size());
+            sec.deltas.emplace_back(id, 1);
+        }
+    }
+}
+
+void WindowBatch::clear()
+{
+    for (size_t i = 0; i < used_; ++i) {
+        seconds_[i].deltas.clear();
+    }
+    used_ = 0;
+    slot_count_ = 0;
+    word_count_ = 0;
+    max_timestamp_ = 0;
+}
+
+size_t WindowBatch::secondFor(unsigned int ts)
+{
+    // 输入基本按时间递增，先看最后一秒，再从后往前找
+    // 只能并入之后没有出现更晚时间戳的秒：否则该时间槽到达时的“当前时间”已经更晚，
+    // addBatch 按秒判断迟到会与逐个 addData 不一致，此时另起一秒，按到达顺序判断
+    for (size_t i = used_; i > 0; --i) {
+        if (seconds_[i - 1].timestamp == ts) {
+            return i - 1;
+        }
+        if (seconds_[i - 1].timestamp > ts) {
+            break;
+        }
+    }
+
+    if (used_ == seconds_.size()) {
+        seconds_.emplace_back();
+    }
+    Second& sec = seconds_[used_];
+    sec.timestamp = ts;
+    sec.deltas.clear();
+    return used_++;
+}
@@ -0,0 +1,12 @@
+#include "WordCounter.h"
+#include "TopKCounter.h"
+#include "CountMinCounter.h"
+
+std::unique_ptr<WordCounter> makeWordCounter(const CounterOptions &options, unsigned int window_size)
+{
+    if (options.approximate) {
+        return std::make_unique<CountMinCounter>(options.epsilon, options.delta, options.heavy_hitters,
+                                                 window_size, options.panes);
+    }
+    return std::make_unique<TopKCounter>();
+}
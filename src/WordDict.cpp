@@ -0,0 +1,64 @@
+#include "WordDict.h"
+#include <mutex>
+
+WordDict &WordDict::instance()
+{
+    static WordDict dict;
+    return dict;
+}
+
+WordId WordDict::intern(std::string_view word)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = ids_.find(word);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    // 双重检查：加写锁期间可能已被其他线程插入
+    auto it = ids_.find(word);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+
+    WordId id = static_cast<WordId>(words_.size());
+    words_.emplace_back(word);
+    ids_.emplace(std::string_view(words_.back()), id);
+    return id;
+}
+
+std::vector<WordId> WordDict::internAll(const std::vector<std::string> &words)
+{
+    std::vector<WordId> result;
+    result.reserve(words.size());
+    for (const auto& word : words) {
+        result.push_back(intern(word));
+    }
+    return result;
+}
+
+bool WordDict::find(std::string_view word, WordId &id) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(word);
+    if (it == ids_.end()) {
+        return false;
+    }
+    id = it->second;
+    return true;
+}
+
+const std::string &WordDict::word(WordId id) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return words_[id];
+}
+
+size_t WordDict::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return words_.size();
+}
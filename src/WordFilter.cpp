@@ -0,0 +1,117 @@
+#include "WordFilter.h"
+#include <algorithm>
+#include <unordered_map>
+
+void WordFilter::add(std::string_view word, uint8_t flag)
+{
+    if (word.empty() || word.size() > UINT16_MAX) {
+        return;
+    }
+    pending_.emplace_back(std::string(word), flag);
+}
+
+void WordFilter::build()
+{
+    // 再次 build 时保留已编译的词条
+    if (entries_ > 0) {
+        std::vector<std::pair<std::string, uint8_t>> all;
+        all.reserve(entries_ + pending_.size());
+        for (const Slot& slot : slots_) {
+            if (slot.length != 0) {
+                all.emplace_back(pool_.substr(slot.offset, slot.length), slot.flags);
+            }
+        }
+        all.insert(all.end(), std::make_move_iterator(pending_.begin()), std::make_move_iterator(pending_.end()));
+        pending_.swap(all);
+    }
+
+    // 合并重复词条的标记，保持首次出现的顺序
+    std::unordered_map<std::string_view, size_t> index;
+    std::vector<std::pair<std::string_view, uint8_t>> words;
+    index.reserve(pending_.size());
+    words.reserve(pending_.size());
+    for (const auto& entry : pending_) {
+        auto it = index.find(entry.first);
+        if (it == index.end()) {
+            index.emplace(entry.first, words.size());
+            words.emplace_back(entry.first, entry.second);
+        } else {
+            words[it->second].second |= entry.second;
+        }
+    }
+
+    size_t pool_size = 0;
+    for (const auto& w : words) {
+        pool_size += w.first.size();
+    }
+
+    size_t capacity = 2;
+    while (capacity < words.size() * 2) {
+        capacity <<= 1;
+    }
+    size_t bloom_bits = 64;
+    unsigned bloom_log = 6;
+    while (bloom_bits < words.size() * 16) {
+        bloom_bits <<= 1;
+        ++bloom_log;
+    }
+
+    std::string pool;
+    pool.reserve(pool_size);
+    std::vector<Slot> slots(capacity);
+    std::vector<uint64_t> bloom(bloom_bits / 64, 0);
+    uint64_t bloom_mask = bloom_bits - 1;
+    unsigned bloom_shift = 64 - bloom_log;
+    size_t min_length = words.empty() ? 1 : SIZE_MAX;
+    size_t max_length = 0;
+
+    for (const auto& w : words) {
+        uint64_t h = hash(w.first);
+        size_t i = h & (capacity - 1);
+        while (slots[i].length != 0) {
+            i = (i + 1) & (capacity - 1);
+        }
+        slots[i].hash = h;
+        slots[i].offset = static_cast<uint32_t>(pool.size());
+        slots[i].length = static_cast<uint16_t>(w.first.size());
+        slots[i].flags = w.second;
+        pool.append(w.first);
+
+        uint64_t a = h >> bloom_shift;
+        uint64_t b = (h >> 20) & bloom_mask;
+        bloom[a >> 6] |= uint64_t(1) << (a & 63);
+        bloom[b >> 6] |= uint64_t(1) << (b & 63);
+
+        min_length = std::min(min_length, w.first.size());
+        max_length = std::max(max_length, w.first.size());
+    }
+
+    pool_.swap(pool);
+    slots_.swap(slots);
+    slot_mask_ = capacity - 1;
+    bloom_.swap(bloom);
+    bloom_mask_ = bloom_mask;
+    bloom_shift_ = bloom_shift;
+    min_length_ = min_length;
+    max_length_ = max_length;
+    entries_ = words.size();
+
+    // 词串已拷入 pool_，释放暂存区（words 中的视图指向 pending_，因此放在最后）
+    std::vector<std::pair<std::string, uint8_t>>().swap(pending_);
+}
+
+size_t WordFilter::count(uint8_t flag) const
+{
+    size_t n = 0;
+    for (const Slot& slot : slots_) {
+        if (slot.length != 0 && (slot.flags & flag) != 0) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+size_t WordFilter::memoryUsage() const
+{
+    return pool_.capacity() + slots_.capacity() * sizeof(Slot) + bloom_.capacity() * sizeof(uint64_t);
+}
@@ -0,0 +1,59 @@
+// 词典快照生成工具：解析文本词典和 HMM 模型，写出供 TextProcessor 启动时直接加载的二进制快照
+// 用法：dict_snapshot [词典目录，默认 ../dict/]
+// 词典文件更新后需重新生成；快照与词典文件大小/修改时间不一致时会被忽略
+#include "TextProcessor.h"
+#include "spdlog/spdlog.h"
+#include <chrono>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+    std::string dict_path = argc > 1 ? argv[1] : "../dict/";
+    if (!dict_path.empty() && dict_path.back() != '/') {
+        dict_path += '/';
+    }
+    std::string snapshot_path = dict_path + DICT_SNAPSHOT_FILE;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    //不传快照路径，强制从文本词典构建
+    cppjieba::Jieba jieba(
+        dict_path + "jieba.dict.utf8",
+        dict_path + "hmm_model.utf8",
+        dict_path + "user.dict.utf8",
+        dict_path + "idf.utf8",
+        dict_path + "stop_words.utf8"
+    );
+
+    auto built = std::chrono::high_resolution_clock::now();
+
+    if (!jieba.SaveSnapshot(snapshot_path)) {
+        spdlog::error("Failed to write dictionary snapshot: {}", snapshot_path);
+        return 1;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    spdlog::info("Dictionary built from text in {:.2f}ms",
+                 std::chrono::duration<double, std::milli>(built - start).count());
+    spdlog::info("Snapshot written to {} in {:.2f}ms", snapshot_path,
+                 std::chrono::duration<double, std::milli>(end - built).count());
+
+    //重新加载一次，确认快照可用
+    auto verify_start = std::chrono::high_resolution_clock::now();
+    cppjieba::Jieba check(
+        dict_path + "jieba.dict.utf8",
+        dict_path + "hmm_model.utf8",
+        dict_path + "user.dict.utf8",
+        dict_path + "idf.utf8",
+        dict_path + "stop_words.utf8",
+        snapshot_path
+    );
+    if (!check.LoadedFromSnapshot()) {
+        spdlog::error("Snapshot {} could not be loaded back", snapshot_path);
+        return 1;
+    }
+    spdlog::info("Snapshot verified, load time {:.2f}ms",
+                 std::chrono::duration<double, std::milli>(
+                     std::chrono::high_resolution_clock::now() - verify_start).count());
+    return 0;
+}
@@ -97,7 +97,7 @@ int main(int argc, char* argv[]){
 
      // 检查参数数量
     if (argc < 3) {
-        spdlog::error("参数不足！需要: <input_file> <output_file>");
+        spdlog::error("参数不足！需要: <input_file> <output_file> [--mask-sensitive]");
         spdlog::shutdown(); // 关键：退出前关闭日志
         return 1;
     }
@@ -105,6 +105,17 @@ int main(int argc, char* argv[]){
     input_file += argv[1];
     output_file += argv[2];
 
+    //可选参数：--mask-sensitive 在分词前屏蔽原文中的敏感词子串
+    bool mask_sensitive = false;
+    for (int i = 3; i < argc; ++i) {
+        string option = argv[i];
+        if (option == "--mask-sensitive") {
+            mask_sensitive = true;
+        } else {
+            spdlog::warn("未知参数: {}", option);
+        }
+    }
+
     spdlog::info("Input file: {}", input_file);
     spdlog::info("Output file: {}", output_file);
 
@@ -112,10 +123,11 @@ int main(int argc, char* argv[]){
         auto start_time=chrono::high_resolution_clock::now();
 
         spdlog::info("Creating HotWordSystem instance...");
-        spdlog::info("Parameters: buffer_capacity_=300s, low_watermark_=60s, window_size_=600, running_=1");
+        spdlog::info("Parameters: buffer_capacity_=300s, low_watermark_=60s, window_size_=600, running_=1, mask_sensitive={}",
+                     mask_sensitive ? 1 : 0);
         
         //创建热词统计系统
-        HotWordSystem system(input_file,output_file,300, 60,600,1);
+        HotWordSystem system(input_file,output_file,300, 60,600,1,0,CounterOptions(),mask_sensitive);
 
         spdlog::info("HotWordSystem created successfully");
 
@@ -5,6 +5,7 @@
 #include "IntegrationTestBase.h"
 #include "SlidingWindow.h"
 #include "QueryHandler.h"
+#include "WordDict.h"
 #include<iostream>
 using namespace std;
 
@@ -30,13 +31,13 @@ class test_SW_QH:public IntegrationTestBase{
 
         //测试窗口1
         TimeSlot slot1(100);
-        slot1.words = {"人工智能", "技术", "人工智能", "发展", "人工智能", "技术"};
+        slot1.words = WordDict::instance().internAll({"人工智能", "技术", "人工智能", "发展", "人工智能", "技术"});
         window.addData(slot1);
         LOG("添加第1个时间槽: timestamp=100, 词数=6");
 
         //测试能否追加（同一时间戳）
         TimeSlot slot4(100);
-        slot4.words = {"中山大学", "孙中山", "中山大学", "发展", "中山大学", "孙中山"};
+        slot4.words = WordDict::instance().internAll({"中山大学", "孙中山", "中山大学", "发展", "中山大学", "孙中山"});
         window.addData(slot4);
         LOG("添加第2个时间槽: timestamp=100, 词数=6");
 
@@ -46,7 +47,7 @@ class test_SW_QH:public IntegrationTestBase{
         LOG("  查询1: timestamp=100, Top-3");
 
         TimeSlot slot2(200);
-        slot2.words = {"技术", "创新", "人工智能", "技术"};
+        slot2.words = WordDict::instance().internAll({"技术", "创新", "人工智能", "技术"});
         window.addData(slot2);
         LOG("添加第3个时间槽: timestamp=200, 词数=4");
 
@@ -57,7 +58,7 @@ class test_SW_QH:public IntegrationTestBase{
 
         //测试窗口二，淘汰机制
         TimeSlot slot3(500);
-        slot3.words = {"创新", "技术", "创新", "创新", "创新", "发展"};
+        slot3.words = WordDict::instance().internAll({"创新", "技术", "创新", "创新", "创新", "发展"});
         window.addData(slot3);
         LOG("添加第4个时间槽: timestamp=500, 词数=6");
         
@@ -49,7 +49,7 @@ class test_IP_IH:public IntegrationTestBase{
                     ", k=" + std::to_string(k));
                 ASSERT_GT(k, 0, "查询K值必须大于0");
             } else {
-                auto words = processor.processWithPOS(text);
+                auto words = processor.processWithPOSToIds(text);
 
                 if(time_slot_map.find(timestamp)==time_slot_map.end()){
                     time_slot_map[timestamp]=TimeSlot(timestamp);
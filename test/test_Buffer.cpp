@@ -0,0 +1,190 @@
+#include "Buffer.h"
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+using namespace std;
+
+/**
+ * 单生产者写入 n 个递增整数，consumers 个消费者读取，检查不重不漏
+ * 单消费者时还要求顺序与写入一致
+ */
+void run_transfer(BufferMode mode, size_t consumers, int n){
+    Buffer<int> buffer(16, 4, mode);
+    vector<vector<int>> got(consumers);
+
+    thread producer([&](){
+        for(int i=0;i<n;i++){
+            assert(buffer.push(i));
+        }
+        buffer.markInputFinished();
+    });
+
+    vector<thread> workers;
+    for(size_t c=0;c<consumers;c++){
+        workers.emplace_back([&,c](){
+            int v;
+            while(buffer.pop(v)){
+                got[c].push_back(v);
+            }
+        });
+    }
+
+    producer.join();
+    for(auto& w:workers){
+        w.join();
+    }
+
+    vector<char> seen(n,0);
+    size_t total=0;
+    for(auto& g:got){
+        for(size_t i=0;i<g.size();i++){
+            assert(!seen[g[i]]);
+            seen[g[i]]=1;
+            if(i>0) assert(g[i]>g[i-1]);//每个消费者看到的顺序都是递增的
+        }
+        total+=g.size();
+    }
+    assert(total==(size_t)n);
+    assert(buffer.empty());
+}
+
+/**
+ * 批量接口：pushBatch 每次写入 7 个，popBatch 每次至多取 5 个，结果与逐个读写一致
+ */
+void run_transfer_batch(BufferMode mode, size_t consumers, int n){
+    Buffer<int> buffer(16, 4, mode);
+    vector<vector<int>> got(consumers);
+
+    thread producer([&](){
+        vector<int> items;
+        for(int i=0;i<n;i++){
+            items.push_back(i);
+            if(items.size()==7 || i==n-1){
+                assert(buffer.pushBatch(items)==items.size());
+                items.clear();
+            }
+        }
+        buffer.markInputFinished();
+    });
+
+    vector<thread> workers;
+    for(size_t c=0;c<consumers;c++){
+        workers.emplace_back([&,c](){
+            vector<int> out;
+            size_t n_popped;
+            while((n_popped=buffer.popBatch(out,5))>0){
+                assert(n_popped<=5);
+            }
+            got[c]=out;
+        });
+    }
+
+    producer.join();
+    for(auto& w:workers){
+        w.join();
+    }
+
+    vector<char> seen(n,0);
+    size_t total=0;
+    for(auto& g:got){
+        for(size_t i=0;i<g.size();i++){
+            assert(!seen[g[i]]);
+            seen[g[i]]=1;
+            if(i>0) assert(g[i]>g[i-1]);
+        }
+        total+=g.size();
+    }
+    assert(total==(size_t)n);
+
+    //关闭后 pushBatch 返回已写入的个数
+    Buffer<int> closed(4, 1, mode);
+    closed.close();
+    vector<int> items={1,2,3};
+    assert(closed.pushBatch(items)==0);
+}
+
+/**
+ * 水位线：写满后生产者阻塞，取到低水位以下才恢复写入
+ */
+void test_watermark(BufferMode mode){
+    Buffer<int> buffer(8, 3, mode);
+    for(int i=0;i<8;i++){
+        assert(buffer.push(i));
+    }
+    assert(buffer.size()==8);
+
+    atomic<bool> pushed(false);
+    thread producer([&](){
+        buffer.push(8);
+        pushed.store(true);
+    });
+
+    int v;
+    for(int i=0;i<4;i++){//剩 4 个，仍高于低水位
+        assert(buffer.pop(v) && v==i);
+    }
+    this_thread::sleep_for(chrono::milliseconds(50));
+    assert(!pushed.load());
+
+    assert(buffer.pop(v) && v==4);//剩 3 个，恢复写入
+    producer.join();
+    assert(pushed.load());
+    assert(buffer.size()==4);
+}
+
+/**
+ * close：阻塞的生产者返回 false；markInputFinished：取完剩余数据后 pop 返回 false
+ */
+void test_shutdown(BufferMode mode){
+    Buffer<int> full(2, 0, mode);
+    assert(full.push(1) && full.push(2));
+    bool result=true;
+    thread producer([&](){ result=full.push(3); });
+    this_thread::sleep_for(chrono::milliseconds(20));
+    full.close();
+    producer.join();
+    assert(!result);
+
+    Buffer<int> buffer(4, 1, mode);
+    int v=0;
+    bool popped=true;
+    thread consumer([&](){ popped=buffer.pop(v); });
+    this_thread::sleep_for(chrono::milliseconds(20));
+    buffer.markInputFinished();
+    consumer.join();
+    assert(!popped);
+
+    Buffer<int> rest(4, 1, mode);
+    rest.push(7);
+    rest.markInputFinished();
+    assert(rest.pop(v) && v==7);
+    assert(!rest.pop(v));
+}
+
+int main(){
+    BufferMode modes[]={BufferMode::Locked, BufferMode::SPSC, BufferMode::MPMC};
+    for(BufferMode mode:modes){
+        run_transfer(mode, 1, 200000);
+        test_watermark(mode);
+        test_shutdown(mode);
+    }
+    run_transfer(BufferMode::Locked, 4, 200000);
+    run_transfer(BufferMode::MPMC, 4, 200000);
+    for(BufferMode mode:modes){
+        run_transfer_batch(mode, 1, 200000);
+    }
+    run_transfer_batch(BufferMode::Locked, 4, 200000);
+    run_transfer_batch(BufferMode::MPMC, 4, 200000);
+
+    cout<<"Buffer Pass"<<endl;
+    return 0;
+}
+
+/**
+ * cd HotWordsStatics/test
+ * g++ -std=c++17 test_Buffer.cpp -I../include -pthread -o test_Buffer
+ * ./test_Buffer
+ */
@@ -0,0 +1,206 @@
+#include "CountMinCounter.h"
+#include "TopKCounter.h"
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+
+using namespace std;
+
+void test_basic(){
+    CountMinCounter c(0.001, 0.01, 4);
+    assert(c.depth()==5);
+    assert(c.width()>=2719);
+
+    c.add(1, 3);
+    c.add(2, 5);
+    c.add(3, 1);
+    c.add(1, 4);
+
+    //少量词时没有碰撞，估计值即真实值
+    vector<pair<WordId, int>> top;
+    c.topK(2, top);
+    assert(top.size()==2);
+    assert(top[0].first==1 && top[0].second==7);
+    assert(top[1].first==2 && top[1].second==5);
+    assert(c.count(3)==1);
+    assert(c.total()==13);
+    assert(c.unique()==3);
+
+    //减到 0 后移出候选
+    c.add(2, -5);
+    assert(c.count(2)==0);
+    assert(c.total()==8);
+    c.topK(10, top);
+    assert(top.size()==2);
+    assert(c.unique()==2);
+
+    //候选已满时，估计值更高的词换出最低的候选
+    c.add(4, 2);
+    c.add(5, 2);
+    c.add(6, 9);
+    c.topK(10, top);
+    assert(top.size()==4);
+    assert(top[0].first==6 && top[0].second==9);
+    assert(top[1].first==1);
+
+    cout << "test_basic passed"<<endl;
+}
+
+//与精确计数对照：Zipf 分布的流，含按窗口淘汰的负增量
+void test_against_exact(){
+    const double epsilon=0.001;
+    CountMinCounter approx(epsilon, 0.01, 64);
+    TopKCounter exact;
+
+    mt19937 rng(11);
+    const int vocab=50000;
+    vector<double> weights;
+    for (int i = 1; i <= vocab; ++i) {
+        weights.push_back(1.0 / i);
+    }
+    discrete_distribution<int> zipf(weights.begin(), weights.end());
+
+    //每秒 200 个词，窗口 60 秒
+    vector<vector<WordId>> seconds;
+    for (int t = 0; t < 300; ++t) {
+        seconds.emplace_back();
+        for (int i = 0; i < 200; ++i) {
+            WordId id = static_cast<WordId>(zipf(rng));
+            seconds.back().push_back(id);
+            approx.add(id, 1);
+            exact.add(id, 1);
+        }
+        if (t >= 60) {
+            for (WordId id : seconds[t - 60]) {
+                approx.add(id, -1);
+                exact.add(id, -1);
+            }
+        }
+    }
+    assert(approx.total()==exact.total());
+
+    //估计值不低于真实值，超出误差上限的比例不超过 delta
+    size_t bound=approx.errorBound();
+    int over=0;
+    for (WordId id = 0; id < static_cast<WordId>(vocab); ++id) {
+        int est=approx.count(id);
+        int real=exact.count(id);
+        assert(est>=real);
+        over += est - real > static_cast<int>(bound);
+    }
+    assert(over <= vocab / 100);
+
+    //高频词与精确结果一致
+    vector<pair<WordId, int>> a, e;
+    approx.topK(10, a);
+    exact.topK(10, e);
+    assert(a.size()==10);
+    unordered_set<WordId> exact_top;
+    for (const auto& kv : e) {
+        exact_top.insert(kv.first);
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        assert(exact_top.count(a[i].first));
+        assert(a[i].second>=exact.count(a[i].first));
+        assert(a[i].second<=exact.count(a[i].first)+static_cast<int>(bound));
+    }
+
+    //线性计数估计的不同词数在 10% 以内
+    double ratio=static_cast<double>(approx.unique())/exact.unique();
+    assert(ratio>0.9 && ratio<1.1);
+
+    //内存与词表大小无关
+    assert(approx.memoryUsage()<exact.memoryUsage());
+
+    cout << "test_against_exact passed"<<endl;
+}
+
+//碰撞词被减去后，候选中保存的旧估计值不能直接返回
+void test_stale_candidates(){
+    CountMinCounter c(0.5, 0.5, 4);//单行 64 列，容易碰撞
+    assert(c.depth()==1);
+
+    c.add(1, 10);
+    WordId other=2;
+    while (c.count(other)==0) {
+        ++other;
+    }
+    //other 与 1 落在同一列：加入时估计值为 11，1 被减去后真实估计值只剩 1
+    c.add(other, 1);
+    c.add(1, -9);
+
+    vector<pair<WordId, int>> top;
+    c.topK(4, top);
+    for (const auto& kv : top) {
+        assert(kv.second==c.count(kv.first));
+    }
+    for (size_t i = 1; i < top.size(); ++i) {
+        assert(top[i-1].second>=top[i].second);
+    }
+
+    cout << "test_stale_candidates passed"<<endl;
+}
+
+//按时间段淘汰：整段减去后计数、总数和候选同步减少，内存不随写入的词数增长
+void test_panes(){
+    CountMinCounter c(0.001, 0.01, 4, 9, 5);//窗口 10 秒分 5 段，每段 2 秒
+    assert(c.windowed());
+    assert(c.paneSeconds()==2);
+
+    c.addAt(0, 1, 3);
+    c.addAt(1, 2, 5);
+    c.addAt(3, 1, 4);
+    assert(c.count(1)==7);
+    assert(c.total()==12);
+
+    //第 0 段为 [0, 2)，淘汰线到 2 才整段淘汰
+    c.expireBefore(1);
+    assert(c.count(2)==5);
+    c.expireBefore(2);
+    assert(c.count(1)==4);
+    assert(c.count(2)==0);
+    assert(c.total()==4);
+    assert(c.unique()==1);
+    vector<pair<WordId, int>> top;
+    c.topK(10, top);
+    assert(top.size()==1 && top[0].first==1 && top[0].second==4);
+
+    //未淘汰就复用同一位置的旧段时先减去
+    c.addAt(14, 3, 1);//第 7 段与第 1 段（[2, 4)）同一位置
+    assert(c.count(1)==0);
+    assert(c.count(3)==1);
+    assert(c.total()==1);
+
+    //大量一次性词：内存只取决于矩阵大小、段数和候选数
+    size_t memory=0;
+    for (unsigned int t = 20; t < 220; ++t) {
+        c.expireBefore(t > 9 ? t - 9 : 0);
+        for (WordId id = 0; id < 100; ++id) {
+            c.addAt(t, t * 100 + id, 1);
+        }
+        if (t == 120) {
+            memory=c.memoryUsage();
+        }
+    }
+    assert(c.memoryUsage()==memory);
+    assert(c.total()<=1000);
+
+    cout << "test_panes passed"<<endl;
+}
+
+int main(){
+    test_basic();
+    test_against_exact();
+    test_stale_candidates();
+    test_panes();
+    cout << "All CountMinCounter tests passed!" << endl;
+    return 0;
+}
+
+/**
+ * cd HotWordsStatics/test
+ * g++ -std=c++17 test_CountMinCounter.cpp ../src/CountMinCounter.cpp ../src/TopKCounter.cpp -I../include -o test_CountMinCounter
+ * ./test_CountMinCounter
+ */
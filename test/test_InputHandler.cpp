@@ -1,6 +1,8 @@
 #include "InputHandler.h"
 #include <cassert>
 #include <iostream>
+#include <fstream>
+#include <vector>
 
 int main(){
     InputHandler handler("../data/input_handler.txt");
@@ -27,6 +29,58 @@ int main(){
     assert(timestamp[0]==1201 && text[0]=="都是门糜芳傅士仁的锅");
     assert(timestamp[1]==3602 && text[1]=="徐庶不走就好了");
 
+    //mmap 零拷贝模式与流式读取逐行结果一致
+    InputHandler mapped("../data/input1.txt");
+    InputHandler streamed("../data/input1.txt", false);
+    assert(mapped.open() && streamed.open());
+    assert(mapped.mapped() && !streamed.mapped());
+
+    std::string_view view;
+    string line;
+    int k2;
+    bool is_query2;
+    size_t lines=0;
+    while(!mapped.eof()){
+        bool ok1=mapped.readLine(timestamp[0],view,is_query,k);
+        bool ok2=streamed.readLine(timestamp[1],line,is_query2,k2);
+        assert(ok1==ok2);
+        if(!ok1) break;
+        assert(timestamp[0]==timestamp[1] && view==line && is_query==is_query2 && k==k2);
+        lines++;
+    }
+    assert(!streamed.readLine(timestamp[1],line,is_query2,k2));
+    assert(lines>0);
+
+    //格式错误的行被跳过并计数
+    {
+        const char* path="/tmp/test_InputHandler_malformed.txt";
+        std::ofstream out(path);
+        out<<"[0:00:05] 正常的一行\r\n"
+           <<"\n"
+           <<"0:00:06 缺少括号\n"
+           <<"[0:61:00] 分钟越界\n"
+           <<"[ACTION] QUERY K=abc\n"
+           <<"[ACTION] QUERY K=2\n"
+           <<"[0:00:03] 迟到的一行\n";
+        out.close();
+
+        InputHandler bad(path);
+        assert(bad.open());
+        vector<unsigned int> times;
+        vector<string> texts;
+        while(!bad.eof()){
+            if(bad.readLine(timestamp[0],text[0],is_query,k)){
+                times.push_back(timestamp[0]);
+                texts.push_back(text[0]);
+            }
+        }
+        const InputParseStats& st=bad.stats();
+        assert(st.lines==7 && st.text_lines==2 && st.query_lines==1);
+        assert(st.blank_lines==1 && st.malformed_timestamp==2 && st.malformed_query==1 && st.out_of_order==1);
+        assert(times.size()==3 && times[0]==5 && times[1]==5 && times[2]==5);
+        assert(texts[0]=="正常的一行" && texts[2]=="迟到的一行");
+    }
+
     std::cout<<"InputHandler Pass"<<endl;
     
     return 0;
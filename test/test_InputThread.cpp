@@ -1,10 +1,163 @@
 #include "InputThread.h"
+#include "StatisticsThread.h"
+#include "WordDict.h"
 #include "Buffer.h"
 #include "Common.h"
 #include <iostream>
 #include <thread>
 #include <queue>
 #include <atomic>
+#include <cassert>
+#include <fstream>
+#include <map>
+
+/**
+ * 运行一次输入线程，按顺序收集 Buffer 中的时间槽和查询队列
+ */
+void collect(size_t num_tokenizers, std::vector<TimeSlot>& slots, std::vector<QueryCommand>& queries,
+             const std::string& input = "../data/input1.txt", bool mask_sensitive = false) {
+    Buffer<TimeSlot> buffer(8, 2);
+    std::queue<QueryCommand> query_queue;
+    std::mutex query_mutex;
+    std::atomic<bool> running(true);
+
+    InputThread input_thread(input, buffer, query_queue, query_mutex, running, 16, num_tokenizers, mask_sensitive);
+    std::thread input_handle([&]() {
+        input_thread.run();
+    });
+
+    TimeSlot slot;
+    while (buffer.pop(slot)) {
+        slots.push_back(slot);
+    }
+    input_handle.join();
+
+    while (!query_queue.empty()) {
+        queries.push_back(query_queue.front());
+        query_queue.pop();
+    }
+}
+
+/**
+ * 多个分词工作线程的输出顺序应与同步分词完全一致
+ */
+void test_tokenizer_order() {
+    std::vector<TimeSlot> serial_slots, parallel_slots;
+    std::vector<QueryCommand> serial_queries, parallel_queries;
+
+    collect(0, serial_slots, serial_queries);
+    collect(4, parallel_slots, parallel_queries);
+
+    assert(serial_slots.size() == parallel_slots.size());
+    for (size_t i = 0; i < serial_slots.size(); ++i) {
+        assert(serial_slots[i].timestamp == parallel_slots[i].timestamp);
+        assert(serial_slots[i].words == parallel_slots[i].words);
+    }
+    assert(serial_queries.size() == parallel_queries.size());
+    for (size_t i = 0; i < serial_queries.size(); ++i) {
+        assert(serial_queries[i].timestamp == parallel_queries[i].timestamp);
+        assert(serial_queries[i].k == parallel_queries[i].k);
+    }
+
+    std::cout << "test_tokenizer_order passed: " << serial_slots.size() << " slots, "
+              << serial_queries.size() << " queries" << std::endl;
+}
+
+/**
+ * 开启敏感词屏蔽后，被分词切开或包含在更长词里（如“赌博机器”）的敏感词不会进入 Buffer
+ */
+void test_mask_sensitive() {
+    const char* path = "/tmp/test_InputThread_sensitive.txt";
+    {
+        std::ofstream out(path);
+        out << "[0:00:01] 这个垃圾广告真多\n"
+            << "[0:00:02] 他是个赌博机器\n"
+            << "[ACTION] QUERY K=3\n";
+    }
+
+    std::vector<TimeSlot> slots;
+    std::vector<QueryCommand> queries;
+    collect(2, slots, queries, path, true);
+
+    assert(slots.size() == 2 && queries.size() == 1);
+    size_t words = 0;
+    for (const auto& slot : slots) {
+        for (WordId id : slot.words) {
+            const std::string& word = WordDict::instance().word(id);
+            assert(word.find("垃圾") == std::string::npos && word.find("赌博") == std::string::npos);
+            ++words;
+        }
+    }
+    assert(words > 0);//只屏蔽敏感词，其余词照常统计
+
+    std::cout << "test_mask_sensitive passed: " << words << " words" << std::endl;
+}
+
+/**
+ * 同一时间戳的文本之间夹着查询：开启微批时，查询结果恰好包含它之前的时间槽，不含之后的
+ */
+void test_query_order() {
+    const char* input = "/tmp/test_InputThread_query_order.txt";
+    const char* output = "/tmp/test_InputThread_query_order_out.txt";
+    {
+        std::ofstream out(input);
+        out << "[0:00:01] 诸葛均出山\n"
+            << "[0:00:01] 丞相风雪\n"
+            << "[ACTION] QUERY K=50\n"
+            << "[0:00:01] 小童哈哈哈\n"
+            << "[0:00:01] 诸葛均风雪\n";
+    }
+
+    //期望：查询之前的时间槽中各词的次数
+    std::vector<TimeSlot> slots;
+    std::vector<QueryCommand> queries;
+    collect(0, slots, queries, input);
+    assert(queries.size() == 1 && queries[0].after_slots == 2 && slots.size() == 4);
+    std::map<std::string, int> expect;
+    size_t after_words = 0;
+    for (size_t i = 0; i < slots.size(); ++i) {
+        for (WordId id : slots[i].words) {
+            if (i < queries[0].after_slots) {
+                expect[WordDict::instance().word(id)]++;
+            } else {
+                ++after_words;
+            }
+        }
+    }
+    assert(!expect.empty() && after_words > 0);
+
+    //完整链路：输入线程 -> Buffer -> 统计线程（微批）-> 滑动窗口 -> 输出
+    Buffer<TimeSlot> buffer(8, 2);
+    std::queue<QueryCommand> query_queue;
+    std::mutex query_mutex;
+    std::atomic<bool> running(true);
+    SlidingWindow window(600);
+    QueryHandler handler(output);
+    handler.open();
+    InputThread input_thread(input, buffer, query_queue, query_mutex, running, 16, 2);
+    StatisticsThread stat_thread(0, buffer, window, handler, query_queue, query_mutex, 64, 1000);
+    std::thread input_handle([&]() { input_thread.run(); });
+    std::thread stat_handle([&]() { stat_thread.run(); });
+    input_handle.join();
+    stat_handle.join();
+    handler.close();
+
+    //解析 "序号. 词 (出现N次)"
+    std::map<std::string, int> got;
+    std::ifstream in(output);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t dot = line.find(". ");
+        size_t paren = line.rfind(" (出现");
+        if (line.empty() || line[0] == '[' || dot == std::string::npos || paren == std::string::npos) {
+            continue;
+        }
+        got[line.substr(dot + 2, paren - dot - 2)] = std::stoi(line.substr(paren + std::string(" (出现").size()));
+    }
+    assert(got == expect);
+
+    std::cout << "test_query_order passed: " << expect.size() << " words before the query" << std::endl;
+}
 
 int main() {
     std::cout << "========== 测试 InputThread ==========" << std::endl;
@@ -26,7 +179,8 @@ int main() {
         query_queue,
         query_mutex,
         running,
-        10  //批量大小
+        10,  //批量大小
+        2   //分词工作线程数
     );
     
     // 启动输入线程
@@ -47,7 +201,7 @@ int main() {
                 
                 // 显示前 3 个词
                 for (size_t i = 0; i < std::min(size_t(3), slot.words.size()); ++i) {
-                    std::cout << "  - " << slot.words[i] << std::endl;
+                    std::cout << "  - " << WordDict::instance().word(slot.words[i]) << std::endl;
                 }
             } else {
                 std::cout << "[消费者] Buffer 为空且输入已完成，退出" << std::endl;
@@ -72,6 +226,10 @@ int main() {
         std::cout << "查询 [时间=" << cmd.timestamp << ", K=" << cmd.k << "]" << std::endl;
     }
     
+    test_tokenizer_order();
+    test_mask_sensitive();
+    test_query_order();
+
     std::cout << "测试完成！" << std::endl;
     
     return 0;
@@ -80,6 +238,6 @@ int main() {
 /**
  * 编译运行:
  * cd HotWordsStatics/src
- * g++ -std=c++17 test_InputThread.cpp InputThread.cpp InputHandler.cpp TextProcessor.cpp -pthread -o test_InputThread -I../include -I../cppjieba/include
+ * g++ -std=c++17 test_InputThread.cpp InputThread.cpp InputHandler.cpp TextProcessor.cpp WordDict.cpp TokenizerPool.cpp WordFilter.cpp SensitiveMatcher.cpp StatisticsThread.cpp SlidingWindow.cpp QueryHandler.cpp TopKCounter.cpp CountMinCounter.cpp WordCounter.cpp WindowBatch.cpp -pthread -lspdlog -o test_InputThread -I../include -I../cppjieba/include
  * ./test_InputThread
  */
\ No newline at end of file
@@ -1,32 +1,66 @@
 #include "QueryHandler.h"
+#include "WordDict.h"
 #include <iostream>
 #include <vector>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cassert>
 
 int main(){
     QueryHandler handler("../data/test_output.txt");
 
-    std::vector<std::pair<std::string, int>> topk1 = {
-        {"中山大学", 15},
-        {"计算机", 12},
-        {"学习", 10},
-        {"深度", 8},
-        {"Python", 6}
+    WordDict& dict = WordDict::instance();
+
+    std::vector<std::pair<WordId, int>> topk1 = {
+        {dict.intern("中山大学"), 15},
+        {dict.intern("计算机"), 12},
+        {dict.intern("学习"), 10},
+        {dict.intern("深度"), 8},
+        {dict.intern("Python"), 6}
     };
 
     std::cout<<"第一次查询结果(300秒)"<<std::endl;
     handler.outputTopK(300,topk1);// 时间戳 300 秒 = [00:05:00]
 
-    std::vector<std::pair<std::string, int>> topk2 = {
-        {"人工智能", 20},
-        {"机器学习", 18},
-        {"神经网络", 15}
+    std::vector<std::pair<WordId, int>> topk2 = {
+        {dict.intern("人工智能"), 20},
+        {dict.intern("机器学习"), 18},
+        {dict.intern("神经网络"), 15}
     };
 
     handler.outputTopK(720, topk2);  // 时间戳 720 秒 = [00:12:00]
     std::cout << "第二次查询结果 (720秒)" << std::endl;
 
-       
+    //结果先进缓冲区，flush 之后文件内容与逐行输出时一致
+    assert(handler.flush());
+    std::ifstream in("../data/test_output.txt");
+    std::stringstream content;
+    content << in.rdbuf();
+    assert(content.str() ==
+           "[00:05:00] Top-5:\n"
+           "1. 中山大学 (出现15次)\n"
+           "2. 计算机 (出现12次)\n"
+           "3. 学习 (出现10次)\n"
+           "4. 深度 (出现8次)\n"
+           "5. Python (出现6次)\n"
+           "\n"
+           "[00:12:00] Top-3:\n"
+           "1. 人工智能 (出现20次)\n"
+           "2. 机器学习 (出现18次)\n"
+           "3. 神经网络 (出现15次)\n"
+           "\n");
+    std::cout << "flush 后文件内容正确" << std::endl;
+
+    //时间戳超过 99 小时不截断
+    QueryHandler long_run("../data/test_output.txt", 0);
+    long_run.outputTopK(360000 + 61, topk2);
+    long_run.close();
+    std::ifstream in2("../data/test_output.txt");
+    std::string first_line;
+    std::getline(in2, first_line);
+    assert(first_line == "[100:01:01] Top-3:");
+
     std::cout << "所有测试完成！请检查 test_output.txt 文件内容。" << std::endl;
 
     return 0;
@@ -35,6 +69,6 @@ int main(){
 
 /**
  * cd HotWordsStatics/src
- * g++ -std=c++17 test_QueryHandler.cpp QueryHandler.cpp -pthread -o test_QueryHandler
+ * g++ -std=c++17 test_QueryHandler.cpp QueryHandler.cpp WordDict.cpp -pthread -o test_QueryHandler
  * ./test_QueryHandler
  */
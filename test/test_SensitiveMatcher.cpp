@@ -0,0 +1,108 @@
+#include "SensitiveMatcher.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+
+using namespace std;
+
+void test_basic(){
+    SensitiveMatcher m;
+    string text = "什么都没有";
+    assert(!m.mask(text));//build 之前不命中
+
+    m.add("垃圾");
+    m.add("垃圾广告");
+    m.add("广告位");
+    m.add("垃圾");//重复模式串去重
+    m.add("");//空串忽略
+    m.build();
+    assert(m.size()==3);
+
+    //整词和被分词切开的子串都能命中
+    string a = "这是垃圾";
+    assert(m.mask(a));
+    assert(a=="这是      ");
+    assert(a.size()==string("这是垃圾").size());//偏移和长度不变
+
+    //重叠命中：垃圾广告 与 广告位 的并集
+    string b = "看垃圾广告位了";
+    assert(m.mask(b, '*'));
+    assert(b=="看***************了");
+
+    //没有命中时原样不动，只读接口不复制
+    string c = "垃 圾广 告";
+    assert(!m.mask(c));
+    assert(c=="垃 圾广 告");
+    string out = "untouched";
+    assert(!m.mask(string_view("普通文本"), out));
+    assert(out=="untouched");
+    assert(m.mask(string_view("有垃圾"), out));
+    assert(out=="有      ");
+
+    assert(m.containsAny("广告位招租"));
+    assert(!m.containsAny("广告招租"));
+
+    //再次 build 保留已有模式串
+    m.add("招租");
+    m.build();
+    assert(m.size()==4);
+    assert(m.containsAny("广告招租"));
+    assert(m.containsAny("垃圾"));
+
+    cout << "test_basic passed"<<endl;
+}
+
+//与逐个模式串查找的朴素实现对照
+void test_against_naive(){
+    mt19937 rng(7);
+    auto random_text = [&rng](size_t min_len, size_t max_len){
+        string w;
+        size_t len = min_len + rng() % (max_len - min_len + 1);
+        for (size_t i = 0; i < len; ++i) {
+            w.push_back(static_cast<char>('a' + rng() % 4));
+        }
+        return w;
+    };
+
+    SensitiveMatcher m;
+    vector<string> patterns;
+    for (int i = 0; i < 300; ++i) {
+        patterns.push_back(random_text(2, 7));
+        m.add(patterns.back());
+    }
+    m.build();
+
+    for (int i = 0; i < 2000; ++i) {
+        string text = random_text(0, 80);
+        string expect = text;
+        for (const string& p : patterns) {
+            for (size_t pos = text.find(p); pos != string::npos; pos = text.find(p, pos + 1)) {
+                for (size_t j = 0; j < p.size(); ++j) {
+                    expect[pos + j] = '#';
+                }
+            }
+        }
+        string got = text;
+        bool hit = m.mask(got, '#');
+        assert(got==expect);
+        assert(hit==(expect!=text));
+        assert(m.containsAny(text)==hit);
+    }
+
+    cout << "test_against_naive passed"<<endl;
+}
+
+int main(){
+    test_basic();
+    test_against_naive();
+    cout << "All SensitiveMatcher tests passed!" << endl;
+    return 0;
+}
+
+/**
+ * cd HotWordsStatics/test
+ * g++ -std=c++17 test_SensitiveMatcher.cpp ../src/SensitiveMatcher.cpp -I../include -o test_SensitiveMatcher
+ * ./test_SensitiveMatcher
+ */
@@ -1,6 +1,11 @@
 #include "SlidingWindow.h"
+#include "WordDict.h"
+#include <atomic>
+#include <chrono>
 #include <cassert>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
@@ -8,10 +13,10 @@ void test_cnt(){
     SlidingWindow w(600);
 
     TimeSlot t1(0);
-    t1.words={"人工智能", "中山大学"};
+    t1.words=WordDict::instance().internAll({"人工智能", "中山大学"});
 
     TimeSlot t2(10);
-    t2.words={"计算机科学与技术","人工智能"};
+    t2.words=WordDict::instance().internAll({"计算机科学与技术","人工智能"});
 
     w.addData(t1);
     w.addData(t2);
@@ -27,10 +32,10 @@ void test_eviction(){
     SlidingWindow w(600);
 
     TimeSlot t1(0);
-    t1.words={"人工智能", "中山大学"};
+    t1.words=WordDict::instance().internAll({"人工智能", "中山大学"});
 
     TimeSlot t2(601);
-    t2.words={"计算机科学与技术","人工智能"};
+    t2.words=WordDict::instance().internAll({"计算机科学与技术","人工智能"});
 
     w.addData(t1);
     w.addData(t2);
@@ -45,29 +50,424 @@ void test_topk(){
     SlidingWindow w(600);
 
     TimeSlot t1(0);
-    t1.words={"人工智能", "中山大学","中山大学","人工智能","人工智能","人工智能","计算机科学与技术"};
+    t1.words=WordDict::instance().internAll({"人工智能", "中山大学","中山大学","人工智能","人工智能","人工智能","计算机科学与技术"});
 
     w.addData(t1);
     auto top2=w.getTopK(2);
     
     assert(top2.size()==2);
-    assert(top2[0].first=="人工智能");
+    assert(WordDict::instance().word(top2[0].first)=="人工智能");
     assert(top2[0].second==4);
-    assert(top2[1].first=="中山大学");
+    assert(WordDict::instance().word(top2[1].first)=="中山大学");
 
     cout << "test_topk passed"<<endl;
 }
 
+void test_late_data(){
+    SlidingWindow w(600);
+
+    TimeSlot t1(100);
+    t1.words={WordDict::instance().intern("人工智能")};
+
+    TimeSlot t2(120);
+    t2.words={WordDict::instance().intern("中山大学")};
+
+    //迟到 10 秒，仍在允许延迟内，计入 110 秒的桶
+    TimeSlot t3(110);
+    t3.words=WordDict::instance().internAll({"人工智能", "中山大学"});
+
+    w.addData(t1);
+    w.addData(t2);
+    w.addData(t3);
+
+    assert(w.getWordCount("人工智能")==2);
+    assert(w.getWordCount("中山大学")==2);
+
+    //窗口推进到 715：100 秒和 110 秒的桶被淘汰，120 秒保留
+    w.addData(TimeSlot(715));
+
+    assert(w.getWordCount("人工智能")==0);
+    assert(w.getWordCount("中山大学")==1);
+    assert(w.getTotalWords()==1);
+
+    cout << "test_late_data passed"<<endl;
+}
+
+//输入中断超过一整圈环形桶后，旧桶仍须被淘汰，不能残留计数
+void test_long_gap(){
+    for (size_t shards : {1, 4}) {
+        SlidingWindow w(10, 60, shards);
+        TimeSlot t1(5);
+        t1.words=WordDict::instance().internAll({"断流", "断流"});
+        w.addData(t1);
+        assert(w.getWordCount("断流")==2);
+
+        TimeSlot t2(100);
+        t2.words={WordDict::instance().intern("恢复")};
+        w.addData(t2);
+        assert(w.getWordCount("断流")==0);
+        assert(w.getTotalWords()==1);
+        assert(w.getUniqueWords()==1);
+
+        //复用旧桶所在位置（100 + 11*k 与 5 同余）后计数仍正确
+        for (unsigned int ts = 101; ts <= 115; ++ts) {
+            TimeSlot slot(ts);
+            slot.words={WordDict::instance().intern("恢复")};
+            w.addData(slot);
+        }
+        assert(w.getWordCount("断流")==0);
+        assert(w.getWordCount("恢复")==11);
+        assert(w.getTotalWords()==11);
+    }
+
+    cout << "test_long_gap passed"<<endl;
+}
+
+//多分片 + 多线程写入，结果与单分片一致
+void test_shards(){
+    SlidingWindow single(600, 600);
+    SlidingWindow sharded(600, 600, 8);
+
+    vector<string> vocab={"人工智能","中山大学","计算机","学习","深度","机器学习","神经网络","Python"};
+    vector<TimeSlot> slots;
+    for (unsigned int ts = 0; ts < 100; ++ts) {
+        TimeSlot slot(ts);
+        for (size_t i = 0; i < vocab.size(); ++i) {
+            for (size_t j = 0; j <= (ts + i) % 5; ++j) {
+                slot.words.push_back(WordDict::instance().intern(vocab[i]));
+            }
+        }
+        slots.push_back(slot);
+    }
+
+    for (const auto& slot : slots) {
+        single.addData(slot);
+    }
+
+    //4 个线程交错写入同一批时间槽（max_delay 覆盖全部时间跨度，不丢弃乱序数据）
+    vector<thread> workers;
+    for (size_t t = 0; t < 4; ++t) {
+        workers.emplace_back([&, t]() {
+            for (size_t i = t; i < slots.size(); i += 4) {
+                sharded.addData(slots[i]);
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    assert(single.getTotalWords()==sharded.getTotalWords());
+    assert(single.getUniqueWords()==sharded.getUniqueWords());
+    for (const auto& word : vocab) {
+        assert(single.getWordCount(word)==sharded.getWordCount(word));
+    }
+
+    auto a=single.getTopK(3);
+    auto b=sharded.getTopK(3);
+    assert(a.size()==b.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        assert(a[i].second==b[i].second);
+    }
+
+    cout << "test_shards passed"<<endl;
+}
+
+void test_batch(){
+    //微批合并（含乱序、迟到超限和窗口淘汰）应与逐个 addData 结果一致
+    SlidingWindow seq(10, 5, 4);
+    SlidingWindow batched(10, 5, 4);
+
+    vector<string> vocab={"人工智能","中山大学","计算机","学习","深度"};
+    vector<unsigned int> times={0,1,1,3,2,8,20,14,21,21,15,30,31,24,32};
+    WindowBatch batch;
+    for (size_t n = 0; n < times.size(); ++n) {
+        TimeSlot slot(times[n]);
+        for (size_t i = 0; i < vocab.size(); ++i) {
+            for (size_t j = 0; j <= (times[n] + i) % 3; ++j) {
+                slot.words.push_back(WordDict::instance().intern(vocab[i]));
+            }
+        }
+        seq.addData(slot);
+        batch.add(slot);
+        if (batch.slotCount() == 4) {
+            batched.addBatch(batch);
+            batch.clear();
+        }
+    }
+    batched.addBatch(batch);
+
+    assert(seq.currentTime()==batched.currentTime());
+    assert(seq.getTotalWords()==batched.getTotalWords());
+    assert(seq.getUniqueWords()==batched.getUniqueWords());
+    for (const auto& word : vocab) {
+        assert(seq.getWordCount(word)==batched.getWordCount(word));
+    }
+
+    //同一秒在更晚的时间戳之后再次出现：逐个 addData 判为迟到丢弃，微批也必须丢弃
+    {
+        SlidingWindow seq2(600, 60, 1);
+        SlidingWindow batched2(600, 60, 1);
+        WindowBatch revisit;
+        vector<pair<unsigned int, string>> slots={{0, "甲"}, {100, "乙"}, {0, "甲"}};
+        for (const auto& s : slots) {
+            TimeSlot slot(s.first);
+            slot.words={WordDict::instance().intern(s.second)};
+            seq2.addData(slot);
+            revisit.add(slot);
+        }
+        batched2.addBatch(revisit);
+        assert(seq2.getWordCount("甲")==1);
+        assert(batched2.getWordCount("甲")==1);
+        assert(batched2.getTotalWords()==seq2.getTotalWords());
+    }
+
+    cout << "test_batch passed"<<endl;
+}
+
+void test_topk_cache(){
+    SlidingWindow w(600, 60, 4);
+    vector<string> vocab={"缓存一","缓存二","缓存三","缓存四","缓存五"};
+
+    TimeSlot t1(0);
+    for (size_t i = 0; i < vocab.size(); ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            t1.words.push_back(WordDict::instance().intern(vocab[i]));
+        }
+    }
+    w.addData(t1);
+    uint64_t v1=w.version();
+    assert(v1>0);
+
+    //同一版本下较小的 K 取较大 K 结果的前缀
+    auto top3=w.getTopK(3);
+    auto top2=w.getTopK(2);
+    assert(top3.size()==3 && top2.size()==2);
+    assert(top2[0]==top3[0] && top2[1]==top3[1]);
+    assert(WordDict::instance().word(top2[0].first)=="缓存五" && top2[0].second==5);
+
+    //K 超过词数时缓存已包含全部词，更大的 K 也能直接返回
+    auto all=w.getTopK(10);
+    assert(all.size()==5);
+    assert(w.getTopK(20).size()==5);
+    assert(w.version()==v1);//查询不改变版本
+
+    //写入后版本递增，缓存失效
+    TimeSlot t2(1);
+    for (int j = 0; j < 10; ++j) {
+        t2.words.push_back(WordDict::instance().intern("缓存一"));
+    }
+    w.addData(t2);
+    assert(w.version()>v1);
+    auto top1=w.getTopK(1);
+    assert(WordDict::instance().word(top1[0].first)=="缓存一" && top1[0].second==11);
+
+    //迟到超限被丢弃的数据不改变窗口，版本不变
+    uint64_t v2=w.version();
+    TimeSlot late(700);
+    w.addData(late);
+    uint64_t v3=w.version();
+    assert(v3>v2);
+    TimeSlot too_late(1);
+    too_late.words.push_back(WordDict::instance().intern("缓存一"));
+    w.addData(too_late);
+    assert(w.version()==v3);
+
+    //淘汰后缓存失效：t1、t2 都已滑出窗口
+    assert(w.getTopK(5).empty());
+
+    cout << "test_topk_cache passed"<<endl;
+}
+
+void test_snapshot_reads(){
+    //读者从快照读取，与写入并发；每个快照内部自洽（全部词都在 Top-K 中时总数与各词之和一致）
+    SlidingWindow w(600, 60, 4);
+    vector<WordId> ids;
+    for (int i = 0; i < 20; ++i) {
+        ids.push_back(WordDict::instance().intern("快照" + to_string(i)));
+    }
+
+    atomic<bool> done{false};
+    atomic<int> reads{0};
+    thread reader([&]{
+        uint64_t last_version=0;
+        do {
+            uint64_t v=w.version();
+            assert(v>=last_version);//版本单调递增
+            last_version=v;
+            auto top=w.getTopK(50);
+            for (size_t i = 1; i < top.size(); ++i) {
+                assert(top[i-1].second>=top[i].second);
+            }
+            ++reads;
+        } while (!done.load());
+    });
+
+    const int seconds=200;
+    for (int t = 0; t < seconds; ++t) {
+        TimeSlot slot(t);
+        for (int i = 0; i <= t % 20; ++i) {
+            slot.words.push_back(ids[i]);
+        }
+        w.addData(slot);
+    }
+    done=true;
+    reader.join();
+    assert(reads.load()>0);
+
+    //写入结束后快照与逐词计数一致
+    auto top=w.getTopK(50);
+    assert(top.size()==20);
+    size_t total=0;
+    for (const auto& kv : top) {
+        assert(kv.second==w.getWordCount(kv.first));
+        total+=kv.second;
+    }
+    assert(total==w.getTotalWords());
+    assert(w.getUniqueWords()==20);
+
+    //之后的快照都按 K=50 保存，较小的 K 直接取前缀
+    auto top5=w.getTopK(5);
+    assert(top5.size()==5 && top5[0]==top[0]);
+
+    cout << "test_snapshot_reads passed"<<endl;
+}
+
+void test_approximate(){
+    //近似模式：高频词与精确模式一致，淘汰后同样减去
+    CounterOptions options;
+    options.approximate=true;
+    options.heavy_hitters=16;
+    options.panes=11;//每段 1 秒，淘汰与精确模式逐秒一致
+    SlidingWindow exact(10, 5, 2);
+    SlidingWindow approx(10, 5, 2, options);
+
+    vector<string> vocab={"近似一","近似二","近似三","近似四"};
+    for (unsigned int t = 0; t < 30; ++t) {
+        TimeSlot slot(t);
+        for (size_t i = 0; i < vocab.size(); ++i) {
+            for (size_t j = 0; j < (i + 1) * (1 + t % 2); ++j) {
+                slot.words.push_back(WordDict::instance().intern(vocab[i]));
+            }
+        }
+        //长尾一次性词
+        for (int j = 0; j < 20; ++j) {
+            slot.words.push_back(WordDict::instance().intern("长尾" + to_string(t) + "_" + to_string(j)));
+        }
+        exact.addData(slot);
+        approx.addData(slot);
+    }
+
+    auto e=exact.getTopK(4);
+    auto a=approx.getTopK(4);
+    assert(a.size()==4);
+    for (size_t i = 0; i < 4; ++i) {
+        assert(a[i].first==e[i].first);
+        assert(a[i].second>=e[i].second);
+    }
+    assert(approx.getTotalWords()==exact.getTotalWords());
+    for (const auto& word : vocab) {
+        assert(approx.getWordCount(word)>=exact.getWordCount(word));
+    }
+
+    cout << "test_approximate passed"<<endl;
+}
+
+//近似模式下大量一次性词：窗口状态的内存有固定上限，不随不同词数增长
+void test_approximate_memory(){
+    CounterOptions options;
+    options.approximate=true;
+    options.epsilon=0.001;//4096 列 x 5 行
+    options.heavy_hitters=64;
+    options.panes=10;
+    SlidingWindow approx(60, 5, 1, options);
+    SlidingWindow exact(60, 5, 1);
+
+    //(总矩阵 + 10 段窗口 + 1 段边界) x 4096 x 5 个 int，另加候选堆和快照
+    const size_t limit=12 * 4096 * 5 * sizeof(int) + 64 * 1024;
+    size_t middle=0;
+    WordId hot=WordDict::instance().intern("常驻热词");
+    for (unsigned int t = 0; t < 300; ++t) {
+        TimeSlot slot(t);
+        slot.words.push_back(hot);
+        for (int j = 0; j < 200; ++j) {
+            slot.words.push_back(WordDict::instance().intern("一次性" + to_string(t) + "_" + to_string(j)));
+        }
+        approx.addData(slot);
+        exact.addData(slot);
+        approx.getTopK(10);
+        assert(approx.estimateMemoryUsage()<limit);
+        if (t == 150) {
+            middle=approx.estimateMemoryUsage();
+        }
+    }
+    //6 万个不同词之后内存不再变化；精确模式的逐词索引随词数增长
+    assert(approx.estimateMemoryUsage()==middle);
+    assert(exact.estimateMemoryUsage()>approx.estimateMemoryUsage());
+
+    //窗口外的数据已整段淘汰，最多多计一段（7 秒）
+    assert(approx.getTotalWords()>=61 * 201 && approx.getTotalWords()<=(61 + 7) * 201);
+    assert(approx.getWordCount(hot)>=61 && approx.getWordCount(hot)<=61 + 7);
+
+    cout << "test_approximate_memory passed"<<endl;
+}
+
+//大 K 查询之后的写入吞吐：写入只递增版本号，不随查询过的 K 逐次重建快照
+void test_ingest_after_large_k(){
+    const int slots=200000;
+    vector<WordId> ids;
+    for (int i = 0; i < 2000; ++i) {
+        ids.push_back(WordDict::instance().intern("吞吐" + to_string(i)));
+    }
+
+    for (size_t shards : {1, 8}) {
+        SlidingWindow w(600, 60, shards);
+        TimeSlot warm(0);
+        warm.words=ids;
+        w.addData(warm);
+        assert(w.getTopK(1000).size()==1000);
+
+        auto start=chrono::steady_clock::now();
+        for (int i = 0; i < slots; ++i) {
+            TimeSlot slot(static_cast<unsigned int>(i / 100));
+            slot.words={ids[i % ids.size()], ids[(i * 7) % ids.size()]};
+            w.addData(slot);
+        }
+        double ms=chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "ingest " << slots << " slots after getTopK(1000), " << shards << " shards: " << ms << " ms" << endl;
+        //写入路径重建快照时需要数百秒，这里只做宽松的上限检查
+        assert(ms < 20000);
+
+        //写入之后的查询按新版本重建一次
+        auto top=w.getTopK(1000);
+        assert(top.size()==1000);
+        for (size_t i = 0; i < 10; ++i) {
+            assert(top[i].second==w.getWordCount(top[i].first));
+        }
+    }
+
+    cout << "test_ingest_after_large_k passed"<<endl;
+}
+
 int main() {
     test_cnt();
     test_eviction();
     test_topk();
+    test_late_data();
+    test_long_gap();
+    test_shards();
+    test_batch();
+    test_topk_cache();
+    test_snapshot_reads();
+    test_ingest_after_large_k();
+    test_approximate();
+    test_approximate_memory();
     std::cout << "All SlidingWindow tests passed!\n";
     return 0;
 }
 
 /**
  * cd HotWordsStatics/src
- * g++ -std=c++17 test_SlidingWindow.cpp SlidingWindow.cpp -pthread -o test_SlidingWindow
+ * g++ -std=c++17 test_SlidingWindow.cpp SlidingWindow.cpp WordDict.cpp TopKCounter.cpp CountMinCounter.cpp WordCounter.cpp WindowBatch.cpp -pthread -o test_SlidingWindow
  * ./test_SlidingWindow
  */
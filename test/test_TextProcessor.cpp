@@ -1,8 +1,11 @@
 #include <iostream>
 #include <fstream>
+#include <cassert>
+#include <cstdio>
 #include <unordered_set>
 #include <string>
 #include "TextProcessor.h"
+#include "WordDict.h"
 
 int main(){
     std::cout << "测试 1: 基础分词对比" << std::endl;
@@ -56,10 +59,66 @@ int main(){
     std::cout << "带词性:   ";
     for (const auto& w : words5_b) std::cout << w << " ";
     std::cout << std::endl;
+
+    std::cout << "测试 6: 词典快照与文本词典结果一致" << std::endl;
+
+    const std::string dict = "../dict/";
+    const std::string snapshot = "/tmp/test_TextProcessor.snapshot.bin";
+    std::remove(snapshot.c_str());
+    cppjieba::Jieba text_jieba(dict + "jieba.dict.utf8", dict + "hmm_model.utf8", dict + "user.dict.utf8",
+                               dict + "idf.utf8", dict + "stop_words.utf8", snapshot);
+    assert(!text_jieba.LoadedFromSnapshot());//快照不存在时回退到文本词典
+    assert(text_jieba.SaveSnapshot(snapshot));
+
+    cppjieba::Jieba snap_jieba(dict + "jieba.dict.utf8", dict + "hmm_model.utf8", dict + "user.dict.utf8",
+                               dict + "idf.utf8", dict + "stop_words.utf8", snapshot);
+    assert(snap_jieba.LoadedFromSnapshot());
+
+    const char* sentences[] = {
+        "我在中山大学的计算机学院学习深度学习，感觉非常好",
+        "今天是2024年1月1日，我在中山大学学习，有500多名学生",
+        "小明硕士毕业于中国科学院计算所，后在日本京都大学深造"
+    };
+    for (const char* sentence : sentences) {
+        std::vector<std::pair<std::string, std::string>> a, b;
+        text_jieba.Tag(sentence, a);
+        snap_jieba.Tag(sentence, b);
+        assert(a == b);
+    }
+    std::remove(snapshot.c_str());
+    std::cout << "快照加载结果一致" << std::endl;
+
+    std::cout << "测试 7: 视图接口与字符串接口结果一致" << std::endl;
+
+    for (const char* sentence : sentences) {
+        std::string text(sentence);
+        auto words = processorPOS.processWithPOS(text);
+        auto ids = processorPOS.processWithPOSToIds(std::string_view(text));
+        assert(ids == WordDict::instance().internAll(words));
+    }
+    std::cout << "processWithPOSToIds 与 processWithPOS 一致" << std::endl;
+
+    std::cout << "测试 8: 分词前屏蔽敏感词子串" << std::endl;
+
+    TextProcessor processorMask("../dict/", true, true);
+    std::string leak = "这个垃圾广告真多";//敏感词被分词切开或包含在更长的词里
+    auto masked = processorMask.processWithPOS(leak);
+    std::cout << "屏蔽后:   ";
+    for (const auto& w : masked) {
+        std::cout << w << " ";
+        assert(w.find("垃圾") == std::string::npos);
+    }
+    std::cout << std::endl;
+    assert(processorMask.processWithPOSToIds(leak) == WordDict::instance().internAll(masked));
+    //不含敏感词的文本结果不变
+    for (const char* sentence : sentences) {
+        assert(processorMask.processWithPOS(sentence) == processorPOS.processWithPOS(sentence));
+    }
+    std::cout << "敏感词子串屏蔽正确" << std::endl;
 }
 
 /**
  * cd HotWordsStatics/src
- * g++ -std=c++17 test_TextProcessor.cpp ../src/TextProcessor.cpp -pthread -o test_TextProcessor -I ../include
+ * g++ -std=c++17 test_TextProcessor.cpp ../src/TextProcessor.cpp ../src/WordDict.cpp ../src/WordFilter.cpp ../src/SensitiveMatcher.cpp -pthread -o test_TextProcessor -I ../include
  * ./test_TextProcessor
  */
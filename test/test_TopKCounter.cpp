@@ -0,0 +1,89 @@
+#include "TopKCounter.h"
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <random>
+
+using namespace std;
+
+void test_basic(){
+    TopKCounter c;
+    c.add(1, 3);
+    c.add(2, 5);
+    c.add(3, 1);
+    c.add(1, 4);
+
+    vector<pair<WordId, int>> top;
+    c.topK(2, top);
+
+    assert(top.size()==2);
+    assert(top[0].first==1 && top[0].second==7);
+    assert(top[1].first==2 && top[1].second==5);
+    assert(c.total()==13);
+    assert(c.unique()==3);
+
+    cout << "test_basic passed"<<endl;
+}
+
+void test_remove(){
+    TopKCounter c;
+    c.add(1, 2);
+    c.add(2, 1);
+    c.add(1, -2);
+
+    assert(c.count(1)==0);
+    assert(c.unique()==1);
+
+    vector<pair<WordId, int>> top;
+    c.topK(10, top);
+    assert(top.size()==1);
+    assert(top[0].first==2);
+
+    cout << "test_remove passed"<<endl;
+}
+
+//与全量排序结果对比
+void test_random(){
+    TopKCounter c;
+    vector<int> ref(200, 0);
+    mt19937 rng(42);
+
+    for (int step = 0; step < 20000; ++step) {
+        WordId id = rng() % ref.size();
+        int delta = static_cast<int>(rng() % 7) - 3;
+        if (ref[id] + delta < 0) delta = -ref[id];
+        ref[id] += delta;
+        c.add(id, delta);
+
+        if (step % 500 == 0) {
+            vector<int> sorted;
+            for (int v : ref) if (v > 0) sorted.push_back(v);
+            sort(sorted.rbegin(), sorted.rend());
+
+            vector<pair<WordId, int>> top;
+            c.topK(20, top);
+            assert(top.size()==min(sorted.size(), size_t(20)));
+            for (size_t i = 0; i < top.size(); ++i) {
+                assert(top[i].second==sorted[i]);
+                assert(ref[top[i].first]==top[i].second);
+            }
+            assert(c.unique()==sorted.size());
+        }
+    }
+
+    cout << "test_random passed"<<endl;
+}
+
+int main() {
+    test_basic();
+    test_remove();
+    test_random();
+    std::cout << "All TopKCounter tests passed!\n";
+    return 0;
+}
+
+/**
+ * cd HotWordsStatics/test
+ * g++ -std=c++17 test_TopKCounter.cpp ../src/TopKCounter.cpp -I../include -o test_TopKCounter
+ * ./test_TopKCounter
+ */
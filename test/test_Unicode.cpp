@@ -0,0 +1,180 @@
+#include "../cppjieba/Unicode.hpp"
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using cppjieba::RuneStr;
+using cppjieba::RuneStrArray;
+using cppjieba::RuneStrLite;
+
+/**
+ * 标量参考实现：逐个调用 DecodeUTF8ToRune，遇到无法解码的字节停止
+ * @return 是否整串都能解码
+ */
+bool decodeScalar(const string& s, vector<RuneStr>& runes){
+    runes.clear();
+    size_t i=0;
+    while (i < s.size()) {
+        RuneStrLite rp=cppjieba::DecodeUTF8ToRune(s.data() + i, s.size() - i);
+        if (rp.len == 0) {
+            return false;
+        }
+        runes.push_back(RuneStr(rp.rune, i, rp.len, runes.size(), 1));
+        i += rp.len;
+    }
+    return true;
+}
+
+bool sameRune(const RuneStr& a, const RuneStr& b){
+    return a.rune == b.rune && a.offset == b.offset && a.len == b.len &&
+           a.unicode_offset == b.unicode_offset && a.unicode_length == b.unicode_length;
+}
+
+/**
+ * 随机文本：以 ASCII 和 3 字节序列（中文）为主，混入 2/4 字节序列、
+ * 孤立的后续字节、非法首字节和被截断的序列
+ */
+string randomText(mt19937& rng){
+    uniform_int_distribution<int> kind(0, 99);
+    uniform_int_distribution<int> length(0, 120);
+    uniform_int_distribution<int> byte(0, 255);
+    string s;
+    int pieces=length(rng);
+    for (int p = 0; p < pieces; ++p) {
+        int k=kind(rng);
+        if (k < 35) {
+            s += static_cast<char>(0x20 + byte(rng) % 0x5F);
+        } else if (k < 80) {
+            uint32_t r=0x4E00 + byte(rng) * 64 + byte(rng) % 64;
+            s += static_cast<char>(0xE0 | (r >> 12));
+            s += static_cast<char>(0x80 | ((r >> 6) & 0x3F));
+            s += static_cast<char>(0x80 | (r & 0x3F));
+        } else if (k < 85) {
+            s += static_cast<char>(0xC2 + byte(rng) % 30);
+            s += static_cast<char>(0x80 | (byte(rng) & 0x3F));
+        } else if (k < 88) {
+            s += static_cast<char>(0xF0 | (byte(rng) & 0x03));
+            for (int j = 0; j < 3; ++j) {
+                s += static_cast<char>(0x80 | (byte(rng) & 0x3F));
+            }
+        } else if (k < 91) {
+            s += static_cast<char>(0x80 | (byte(rng) & 0x3F));//孤立的后续字节
+        } else if (k < 94) {
+            s += static_cast<char>(0xE0 | (byte(rng) & 0x0F));//3 字节序列只剩 1~2 字节
+            if (byte(rng) & 1) {
+                s += static_cast<char>(0x80 | (byte(rng) & 0x3F));
+            }
+        } else if (k < 97) {
+            s += static_cast<char>(0xF8 | (byte(rng) & 0x07));//非法首字节
+        } else {
+            s += static_cast<char>(byte(rng));
+        }
+    }
+    return s;
+}
+
+/**
+ * 批量解码内核从 start 处解码的每个码点都必须与标量结果逐字段一致，
+ * 且不能越过标量解码失败的位置
+ */
+void checkKernel(cppjieba::Utf8BulkDecoder kernel, const string& s, const vector<RuneStr>& expect, size_t start){
+    vector<RuneStr> out(s.size() + 1);
+    size_t i=expect[start].offset;
+    size_t m=kernel(s.data(), s.size(), i, start, out.data());
+    assert(m >= start && m <= expect.size());
+    for (size_t j = start; j < m; ++j) {
+        assert(sameRune(out[j], expect[j]));
+    }
+}
+
+#ifdef CPPJIEBA_UTF8_SIMD
+void test_kernels(){
+    __builtin_cpu_init();
+    bool has_ssse3=__builtin_cpu_supports("ssse3");
+    bool has_avx2=__builtin_cpu_supports("avx2");
+    mt19937 rng(20261017);
+    size_t checked=0;
+
+    for (int round = 0; round < 20000; ++round) {
+        string s=randomText(rng);
+        vector<RuneStr> expect;
+        decodeScalar(s, expect);
+        if (expect.empty()) {
+            continue;
+        }
+        //从开头和一个随机码点处开始
+        size_t starts[2]={0, rng() % expect.size()};
+        for (size_t start : starts) {
+            if (has_ssse3) {
+                checkKernel(cppjieba::DecodeUTF8BulkSSSE3, s, expect, start);
+            }
+            if (has_avx2) {
+                checkKernel(cppjieba::DecodeUTF8BulkAVX2, s, expect, start);
+            }
+            ++checked;
+        }
+    }
+
+    //长段纯 ASCII / 纯中文走整块路径
+    string ascii(100, 'a');
+    string cjk;
+    for (int j = 0; j < 40; ++j) {
+        cjk += "中";
+    }
+    for (const string& s : {ascii, cjk, ascii + cjk, cjk + "\xe4\xb8" + ascii}) {
+        vector<RuneStr> expect;
+        decodeScalar(s, expect);
+        if (has_ssse3) {
+            checkKernel(cppjieba::DecodeUTF8BulkSSSE3, s, expect, 0);
+        }
+        if (has_avx2) {
+            checkKernel(cppjieba::DecodeUTF8BulkAVX2, s, expect, 0);
+        }
+    }
+
+    cout << "test_kernels passed: " << checked << " cases (ssse3=" << has_ssse3
+         << ", avx2=" << has_avx2 << ")" << endl;
+}
+#endif
+
+//DecodeUTF8RunesInString（运行时选择的内核 + 标量收尾）与标量结果完全一致
+void test_dispatch(){
+    mt19937 rng(17);
+    RuneStrArray runes;//复用同一个数组，检查缓冲区复用
+    for (int round = 0; round < 20000; ++round) {
+        string s=randomText(rng);
+        vector<RuneStr> expect;
+        bool ok=decodeScalar(s, expect);
+        bool got=cppjieba::DecodeUTF8RunesInString(s, runes);
+        assert(got == ok);
+        if (!ok) {
+            assert(runes.size() == 0);
+            continue;
+        }
+        assert(runes.size() == expect.size());
+        for (size_t j = 0; j < expect.size(); ++j) {
+            assert(sameRune(runes[j], expect[j]));
+        }
+    }
+
+    cout << "test_dispatch passed (bulk decoder "
+         << (cppjieba::GetUTF8BulkDecoder() ? "enabled" : "disabled") << ")" << endl;
+}
+
+int main(){
+#ifdef CPPJIEBA_UTF8_SIMD
+    test_kernels();
+#endif
+    test_dispatch();
+    cout << "All Unicode tests passed!" << endl;
+    return 0;
+}
+
+/**
+ * cd HotWordsStatics/test
+ * g++ -std=c++17 test_Unicode.cpp -o test_Unicode && ./test_Unicode
+ * g++ -std=c++17 -DCPPJIEBA_NO_SIMD test_Unicode.cpp -o test_Unicode && ./test_Unicode   #只有标量路径
+ */
@@ -0,0 +1,91 @@
+#include "WordFilter.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <random>
+
+using namespace std;
+
+void test_basic(){
+    WordFilter f;
+    assert(f.flags("的")==0);//build 之前查找返回 0
+
+    f.add("的", WordFilter::STOP);
+    f.add("了", WordFilter::STOP);
+    f.add("垃圾", WordFilter::SENSITIVE);
+    f.add("的", WordFilter::SENSITIVE);//重复词条标记取并集
+    f.add("", WordFilter::STOP);//空串忽略
+    f.build();
+
+    assert(f.size()==3);
+    assert(f.flags("的")==(WordFilter::STOP|WordFilter::SENSITIVE));
+    assert(f.contains("了", WordFilter::STOP));
+    assert(!f.contains("了", WordFilter::SENSITIVE));
+    assert(f.contains("垃圾", WordFilter::SENSITIVE));
+    assert(f.flags("垃")==0);
+    assert(f.flags("垃圾桶")==0);
+    assert(f.flags("")==0);
+    assert(f.count(WordFilter::STOP)==2);
+    assert(f.count(WordFilter::SENSITIVE)==2);
+
+    //再次 build 保留已有词条
+    f.add("广告", WordFilter::SENSITIVE);
+    f.build();
+    assert(f.size()==4);
+    assert(f.contains("广告", WordFilter::SENSITIVE));
+    assert(f.flags("的")==(WordFilter::STOP|WordFilter::SENSITIVE));
+
+    cout << "test_basic passed"<<endl;
+}
+
+//与 unordered_set 对照：随机词条全部命中，随机查询结果一致
+void test_against_set(){
+    mt19937 rng(42);
+    auto random_word = [&rng](){
+        string w;
+        size_t len = 1 + rng() % 8;
+        for (size_t i = 0; i < len; ++i) {
+            w.push_back(static_cast<char>('a' + rng() % 6));
+        }
+        return w;
+    };
+
+    WordFilter f;
+    unordered_set<string> stop, sensitive;
+    for (int i = 0; i < 20000; ++i) {
+        string w = random_word();
+        if (i % 3 == 0) {
+            stop.insert(w);
+            f.add(w, WordFilter::STOP);
+        } else {
+            sensitive.insert(w);
+            f.add(w, WordFilter::SENSITIVE);
+        }
+    }
+    f.build();
+
+    for (int i = 0; i < 200000; ++i) {
+        string w = random_word();
+        uint8_t expect = (stop.count(w) ? WordFilter::STOP : 0) |
+                         (sensitive.count(w) ? WordFilter::SENSITIVE : 0);
+        assert(f.flags(w)==expect);
+    }
+    assert(f.count(WordFilter::STOP)==stop.size());
+    assert(f.count(WordFilter::SENSITIVE)==sensitive.size());
+
+    cout << "test_against_set passed"<<endl;
+}
+
+int main(){
+    test_basic();
+    test_against_set();
+    cout << "All WordFilter tests passed!" << endl;
+    return 0;
+}
+
+/**
+ * cd HotWordsStatics/test
+ * g++ -std=c++17 test_WordFilter.cpp ../src/WordFilter.cpp -I../include -o test_WordFilter
+ * ./test_WordFilter
+ */